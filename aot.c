@@ -0,0 +1,30 @@
+/* SimAK65 ahead-of-time recompiled code
+ * Copyright A.K. 2026
+ */
+
+#include "error.h"
+#include "aot.h"
+#include "bus.h"
+#include "simak65.h"
+
+int simak65_aot_attach(struct simak65_cpu *cpu, const struct simak65_aot *aot)
+{
+	u32 i;
+	u16 addr;
+
+	if (aot != NULL) {
+		/* Blocks are only valid for the image they were generated from */
+		for (i = 0; i < aot->size; ++i) {
+			addr = aot->base + i;
+
+			if (!bus_isio(cpu, addr) && cpu->bus.read(addr) != aot->image[i]) {
+				WARN("Recompiled image differs from memory at 0x%04x", addr);
+				return -1;
+			}
+		}
+	}
+
+	cpu->aot = aot;
+
+	return 0;
+}
@@ -0,0 +1,15 @@
+/* SimAK65 ahead-of-time recompiled code
+ * Copyright A.K. 2026
+ */
+
+#ifndef SIMAK65_AOT_H_
+#define SIMAK65_AOT_H_
+
+/* Longest block simak65-recomp generates */
+#define AOT_INSNS 32
+
+/* Upper bound of the cycles a block takes before its last instruction,
+ * which is the only one that may take longer or leave the block */
+#define AOT_CYCLES (AOT_INSNS * 8)
+
+#endif /* SIMAK65_AOT_H_ */
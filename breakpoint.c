@@ -0,0 +1,55 @@
+/* SimAK65 breakpoints
+ * Copyright A.K. 2026
+ *
+ * Breakpoints live in a bitmap over the address space. The bitmap is only
+ * allocated while at least one breakpoint is armed, so the run loop can
+ * choose a path without any check when there are none.
+ */
+
+#include <stdlib.h>
+#include "error.h"
+#include "breakpoint.h"
+#include "simak65.h"
+
+#define BREAKPOINT_BITMAP_SIZE (0x10000 / 8)
+
+int simak65_break_set(struct simak65_cpu *cpu, uint16_t addr)
+{
+	if (cpu->breakpoints == NULL) {
+		cpu->breakpoints = calloc(1, BREAKPOINT_BITMAP_SIZE);
+		if (cpu->breakpoints == NULL)
+			return -1;
+	}
+
+	if (!breakpoint_test(cpu->breakpoints, addr)) {
+		cpu->breakpoints[addr >> 3] |= 1 << (addr & 7);
+		++cpu->nbreakpoints;
+	}
+
+	DEBUG("Breakpoint set at 0x%04x", addr);
+
+	return 0;
+}
+
+void simak65_break_clear(struct simak65_cpu *cpu, uint16_t addr)
+{
+	if (cpu->breakpoints == NULL || !breakpoint_test(cpu->breakpoints, addr))
+		return;
+
+	cpu->breakpoints[addr >> 3] &= ~(1 << (addr & 7));
+
+	if (--cpu->nbreakpoints == 0)
+		simak65_break_clear_all(cpu);
+}
+
+void simak65_break_clear_all(struct simak65_cpu *cpu)
+{
+	free(cpu->breakpoints);
+	cpu->breakpoints = NULL;
+	cpu->nbreakpoints = 0;
+}
+
+int simak65_break_hit(struct simak65_cpu *cpu)
+{
+	return cpu->breakpoints != NULL && breakpoint_test(cpu->breakpoints, cpu->reg.pc);
+}
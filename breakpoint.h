@@ -0,0 +1,16 @@
+/* SimAK65 breakpoints
+ * Copyright A.K. 2026
+ */
+
+#ifndef SIMAK65_BREAKPOINT_H_
+#define SIMAK65_BREAKPOINT_H_
+
+#include "types.h"
+#include "simak65.h"
+
+static inline int breakpoint_test(const u8 *bitmap, u16 addr)
+{
+	return bitmap[addr >> 3] & (1 << (addr & 7));
+}
+
+#endif /* SIMAK65_BREAKPOINT_H_ */
@@ -0,0 +1,124 @@
+/* SimAK65 bus access
+ * Copyright A.K. 2026
+ */
+
+#ifndef SIMAK65_BUS_H_
+#define SIMAK65_BUS_H_
+
+#include "types.h"
+#include "simak65.h"
+#include "log.h"
+#include "watchpoint.h"
+#include "heatmap.h"
+#include "perf.h"
+#include "memo.h"
+
+static inline int bus_isio(const struct simak65_cpu *cpu, u16 addr)
+{
+	return !!(cpu->io[addr >> 13] & ((u32)1 << ((addr >> 8) & 0x1f)));
+}
+
+static inline void bus_dirty(struct simak65_cpu *cpu, u16 addr)
+{
+	cpu->dirty[addr >> 13] |= (u32)1 << ((addr >> 8) & 0x1f);
+}
+
+static inline u8 bus_load(struct simak65_cpu *cpu, u16 addr)
+{
+	if (cpu->log != NULL && bus_isio(cpu, addr))
+		return log_ioread(cpu, addr);
+
+	return cpu->bus.read(addr);
+}
+
+/* Instruction stream read */
+static inline u8 bus_fetch(struct simak65_cpu *cpu, u16 addr)
+{
+	u8 data;
+
+	PERF_INC(cpu, fetches);
+
+	if (cpu->heatmap != NULL)
+		heatmap_count(cpu->heatmap, addr, simak65_heat_fetch, SIMAK65_CLASS_EXEC);
+
+	data = bus_load(cpu, addr);
+
+	if (cpu->memo_rec != NULL)
+		memo_read(cpu, addr, data, 1);
+
+	if (cpu->fetched != NULL)
+		*cpu->fetched++ = data;
+
+	return data;
+}
+
+static inline u8 bus_readkind(struct simak65_cpu *cpu, u16 addr, enum simak65_heat kind)
+{
+	u8 data;
+
+	if (kind == simak65_heat_stack)
+		PERF_INC(cpu, stack_reads);
+	else
+		PERF_INC(cpu, reads);
+
+	if (cpu->watch_read != NULL)
+		watchpoint_check(cpu, cpu->watch_read, addr, 0);
+
+	if (cpu->heatmap != NULL)
+		heatmap_count(cpu->heatmap, addr, kind, SIMAK65_CLASS_DATA);
+
+	data = bus_load(cpu, addr);
+
+	if (cpu->memo_rec != NULL)
+		memo_read(cpu, addr, data, 0);
+
+	return data;
+}
+
+static inline void bus_writekind(struct simak65_cpu *cpu, u16 addr, u8 data, enum simak65_heat kind)
+{
+	if (kind == simak65_heat_stack)
+		PERF_INC(cpu, stack_writes);
+	else
+		PERF_INC(cpu, writes);
+
+	if (cpu->watch_write != NULL)
+		watchpoint_check(cpu, cpu->watch_write, addr, 1);
+
+	if (cpu->heatmap != NULL)
+		heatmap_count(cpu->heatmap, addr, kind, SIMAK65_CLASS_WRITTEN);
+
+	if (cpu->memo_rec != NULL)
+		memo_write(cpu, addr, data);
+
+	bus_dirty(cpu, addr);
+
+	if (cpu->log != NULL && bus_isio(cpu, addr))
+		log_iowrite(cpu, addr, data);
+	else
+		cpu->bus.write(addr, data);
+}
+
+/* Data read */
+static inline u8 bus_read(struct simak65_cpu *cpu, u16 addr)
+{
+	return bus_readkind(cpu, addr, simak65_heat_read);
+}
+
+static inline void bus_write(struct simak65_cpu *cpu, u16 addr, u8 data)
+{
+	bus_writekind(cpu, addr, data, simak65_heat_write);
+}
+
+/* Pull and push */
+static inline u8 bus_pop(struct simak65_cpu *cpu, u16 addr)
+{
+	return bus_readkind(cpu, addr, simak65_heat_stack);
+}
+
+static inline void bus_push(struct simak65_cpu *cpu, u16 addr, u8 data)
+{
+	bus_writekind(cpu, addr, data, simak65_heat_stack);
+}
+
+#endif /* SIMAK65_BUS_H_ */
@@ -0,0 +1,311 @@
+/* SimAK65 call graph profiler
+ * Copyright A.K. 2026
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "error.h"
+#include "callgraph.h"
+#include "simak65.h"
+
+#define CG_NONE 0xffffffffu
+
+/* Call tree node, one per distinct call path. Children always come
+ * after their parent in the node array. */
+struct cg_node {
+	u32 parent;
+	u32 child;
+	u32 sibling;
+	u16 addr;
+	u8 kind;
+	uint64_t calls;
+	/* Cycles spent with this node on top of the shadow stack */
+	uint64_t self;
+};
+
+/* Shadow stack frame, live while the stack pointer is below sp */
+struct cg_frame {
+	u32 node;
+	u8 sp;
+};
+
+struct simak65_callgraph {
+	struct cg_node *nodes;
+	u32 nnodes;
+	u32 size;
+
+	/* Frames have strictly decreasing sp, so 256 are enough */
+	struct cg_frame stack[257];
+	unsigned int depth;
+	unsigned long last;
+};
+
+struct cg_routine {
+	u32 key;
+	uint64_t calls;
+	uint64_t incl;
+	uint64_t excl;
+};
+
+static const char *cg_kind[] = { "root", "sub", "brk", "irq", "nmi" };
+
+static void cg_root(struct simak65_callgraph *cg)
+{
+	memset(&cg->nodes[0], 0, sizeof(cg->nodes[0]));
+	cg->nodes[0].parent = CG_NONE;
+	cg->nodes[0].child = CG_NONE;
+	cg->nodes[0].sibling = CG_NONE;
+	cg->nodes[0].kind = callgraph_root;
+	cg->nnodes = 1;
+
+	cg->stack[0].node = 0;
+	cg->stack[0].sp = 0;
+	cg->depth = 1;
+}
+
+struct simak65_callgraph *simak65_callgraph_create(void)
+{
+	struct simak65_callgraph *cg;
+
+	cg = malloc(sizeof(*cg));
+	if (cg == NULL)
+		return NULL;
+
+	cg->size = 1024;
+	cg->nodes = malloc(cg->size * sizeof(*cg->nodes));
+	if (cg->nodes == NULL) {
+		free(cg);
+		return NULL;
+	}
+
+	cg_root(cg);
+	cg->last = 0;
+
+	return cg;
+}
+
+void simak65_callgraph_destroy(struct simak65_callgraph *cg)
+{
+	if (cg == NULL)
+		return;
+
+	free(cg->nodes);
+	free(cg);
+}
+
+void simak65_callgraph_reset(struct simak65_callgraph *cg)
+{
+	cg_root(cg);
+}
+
+static void cg_charge(struct simak65_callgraph *cg, unsigned long cycles)
+{
+	/* Time may go backwards after a snapshot restore */
+	if (cycles > cg->last)
+		cg->nodes[cg->stack[cg->depth - 1].node].self += cycles - cg->last;
+
+	cg->last = cycles;
+}
+
+void simak65_callgraph_attach(struct simak65_cpu *cpu, struct simak65_callgraph *cg)
+{
+	if (cpu->callgraph != NULL)
+		cg_charge(cpu->callgraph, cpu->cycles);
+
+	if (cg != NULL) {
+		/* The shadow stack starts over, the tree is kept */
+		cg->depth = 1;
+		cg->last = cpu->cycles;
+	}
+
+	cpu->callgraph = cg;
+}
+
+/* Drop frames whose return address is no longer on the stack */
+static void cg_unwind(struct simak65_callgraph *cg, u8 sp)
+{
+	while (cg->depth > 1 && cg->stack[cg->depth - 1].sp <= sp)
+		--cg->depth;
+}
+
+static u32 cg_child(struct simak65_callgraph *cg, u32 parent, u16 addr, u8 kind)
+{
+	struct cg_node *node, *nodes;
+	u32 i;
+
+	for (i = cg->nodes[parent].child; i != CG_NONE; i = cg->nodes[i].sibling) {
+		if (cg->nodes[i].addr == addr && cg->nodes[i].kind == kind)
+			return i;
+	}
+
+	if (cg->nnodes == cg->size) {
+		nodes = realloc(cg->nodes, 2 * cg->size * sizeof(*nodes));
+		if (nodes == NULL) {
+			WARN("Out of memory, call attributed to the caller");
+			return parent;
+		}
+
+		cg->nodes = nodes;
+		cg->size *= 2;
+	}
+
+	i = cg->nnodes++;
+	node = &cg->nodes[i];
+	node->parent = parent;
+	node->child = CG_NONE;
+	node->sibling = cg->nodes[parent].child;
+	node->addr = addr;
+	node->kind = kind;
+	node->calls = 0;
+	node->self = 0;
+	cg->nodes[parent].child = i;
+
+	return i;
+}
+
+void callgraph_enter(struct simak65_cpu *cpu, u8 sp, enum callgraph_kind kind)
+{
+	struct simak65_callgraph *cg = cpu->callgraph;
+	u32 node;
+
+	cg_charge(cg, cpu->cycles);
+
+	/* Frames at or above the new one are stale, e.g. after TXS */
+	cg_unwind(cg, sp);
+
+	node = cg_child(cg, cg->stack[cg->depth - 1].node, cpu->reg.pc, kind);
+	cg->nodes[node].calls++;
+
+	cg->stack[cg->depth].node = node;
+	cg->stack[cg->depth].sp = sp;
+	cg->depth++;
+}
+
+void callgraph_leave(struct simak65_cpu *cpu)
+{
+	struct simak65_callgraph *cg = cpu->callgraph;
+
+	cg_charge(cg, cpu->cycles);
+
+	/* A return leaving the stack below the top frame did not return from
+	 * it, e.g. RTS used as a jump to a pushed address */
+	cg_unwind(cg, cpu->reg.sp);
+}
+
+static int cg_path(const struct simak65_callgraph *cg, u32 node, FILE *f)
+{
+	const struct cg_node *n = &cg->nodes[node];
+
+	if (n->parent == CG_NONE)
+		return (fputs(cg_kind[n->kind], f) < 0) ? -1 : 0;
+
+	if (cg_path(cg, n->parent, f) < 0)
+		return -1;
+
+	return (fprintf(f, ";%s_%04x", cg_kind[n->kind], n->addr) < 0) ? -1 : 0;
+}
+
+int simak65_callgraph_write(const struct simak65_callgraph *cg, FILE *f)
+{
+	u32 i;
+
+	/* Collapsed stacks, one line per call path with exclusive cycles */
+	for (i = 0; i < cg->nnodes; ++i) {
+		if (cg->nodes[i].self == 0)
+			continue;
+
+		if (cg_path(cg, i, f) < 0 || fprintf(f, " %llu\n", (unsigned long long)cg->nodes[i].self) < 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+static int cg_cmpkey(const void *a, const void *b)
+{
+	const struct cg_routine *ra = a, *rb = b;
+
+	return (ra->key > rb->key) - (ra->key < rb->key);
+}
+
+static int cg_cmpincl(const void *a, const void *b)
+{
+	const struct cg_routine *ra = a, *rb = b;
+
+	return (ra->incl < rb->incl) - (ra->incl > rb->incl);
+}
+
+int simak65_callgraph_report(const struct simak65_callgraph *cg, FILE *f)
+{
+	struct cg_routine *r;
+	uint64_t *incl, total;
+	u32 i, j, n;
+	u32 key;
+	char name[16];
+
+	incl = malloc(cg->nnodes * sizeof(*incl));
+	r = malloc(cg->nnodes * sizeof(*r));
+	if (incl == NULL || r == NULL) {
+		free(incl);
+		free(r);
+		return -1;
+	}
+
+	for (i = 0; i < cg->nnodes; ++i)
+		incl[i] = cg->nodes[i].self;
+
+	for (i = cg->nnodes - 1; i > 0; --i)
+		incl[cg->nodes[i].parent] += incl[i];
+
+	total = incl[0];
+
+	for (i = 0; i < cg->nnodes; ++i) {
+		key = ((u32)cg->nodes[i].kind << 16) | cg->nodes[i].addr;
+		r[i].key = key;
+		r[i].calls = cg->nodes[i].calls;
+		r[i].excl = cg->nodes[i].self;
+		r[i].incl = incl[i];
+
+		/* Recursive calls are already included in the outermost one */
+		for (j = cg->nodes[i].parent; j != CG_NONE; j = cg->nodes[j].parent) {
+			if ((((u32)cg->nodes[j].kind << 16) | cg->nodes[j].addr) == key) {
+				r[i].incl = 0;
+				break;
+			}
+		}
+	}
+
+	qsort(r, cg->nnodes, sizeof(*r), cg_cmpkey);
+
+	for (i = 0, n = 0; i < cg->nnodes; ++i) {
+		if (n != 0 && r[n - 1].key == r[i].key) {
+			r[n - 1].calls += r[i].calls;
+			r[n - 1].incl += r[i].incl;
+			r[n - 1].excl += r[i].excl;
+		}
+		else {
+			r[n++] = r[i];
+		}
+	}
+
+	qsort(r, n, sizeof(*r), cg_cmpincl);
+
+	fprintf(f, "; %llu cycles\n", (unsigned long long)total);
+	fprintf(f, "; %-9s %12s %14s %7s %14s %7s\n", "routine", "calls", "inclusive", "incl%", "exclusive", "excl%");
+
+	for (i = 0; i < n; ++i) {
+		if ((r[i].key >> 16) == callgraph_root)
+			snprintf(name, sizeof(name), "%s", cg_kind[callgraph_root]);
+		else
+			snprintf(name, sizeof(name), "%s_%04x", cg_kind[r[i].key >> 16], r[i].key & 0xffff);
+
+		fprintf(f, "  %-9s %12llu %14llu %6.2f%% %14llu %6.2f%%\n", name,
+			(unsigned long long)r[i].calls, (unsigned long long)r[i].incl, total ? 100.0 * r[i].incl / total : 0.0,
+			(unsigned long long)r[i].excl, total ? 100.0 * r[i].excl / total : 0.0);
+	}
+
+	free(incl);
+	free(r);
+
+	return ferror(f) ? -1 : 0;
+}
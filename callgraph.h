@@ -0,0 +1,26 @@
+/* SimAK65 call graph profiler
+ * Copyright A.K. 2026
+ */
+
+#ifndef SIMAK65_CALLGRAPH_H_
+#define SIMAK65_CALLGRAPH_H_
+
+#include "types.h"
+#include "simak65.h"
+
+enum callgraph_kind {
+	callgraph_root,
+	callgraph_jsr,
+	callgraph_brk,
+	callgraph_irq,
+	callgraph_nmi
+};
+
+/* Called after a subroutine call or interrupt entry, sp is the stack
+ * pointer before the return address was pushed */
+void callgraph_enter(struct simak65_cpu *cpu, u8 sp, enum callgraph_kind kind);
+
+/* Called after RTS or RTI */
+void callgraph_leave(struct simak65_cpu *cpu);
+
+#endif /* SIMAK65_CALLGRAPH_H_ */
@@ -2,10 +2,16 @@
  * Copyright A.K. 2018, 2023
  */
 
+#include <stdio.h>
 #include "error.h"
 #include "decoder.h"
+#include "flags.h"
 
-static const struct opinfo decoder_table[] = {
+#define FLAGS_NZ   (FLAG_SIGN | FLAG_ZERO)
+#define FLAGS_NZC  (FLAG_SIGN | FLAG_ZERO | FLAG_CARRY)
+#define FLAGS_NZCV (FLAG_SIGN | FLAG_ZERO | FLAG_CARRY | FLAG_OVRF)
+
+const struct opinfo decoder_table[256] = {
 	{BRK, mode_imp}, {ORA, mode_inx}, {NOP, mode_imp}, {NOP, mode_imp},
 	{NOP, mode_imp}, {ORA, mode_zp},  {ASL, mode_zp},  {NOP, mode_imp},
 	{PHP, mode_imp}, {ORA, mode_imm}, {ASL, mode_acc}, {NOP, mode_imp},
@@ -87,6 +93,68 @@ static const struct opinfo decoder_table[] = {
 	{NOP, mode_imp}, {SBC, mode_abx}, {INC, mode_abx}, {NOP, mode_imp}
 };
 
+/* Flags read and set by every instruction */
+static const struct {
+	u8 read, written;
+} flag_use[] = {
+	[ADC] = { FLAG_CARRY | FLAG_BCD, FLAGS_NZCV },
+	[AND] = { 0, FLAGS_NZ },
+	[ASL] = { 0, FLAGS_NZC },
+	[BCC] = { FLAG_CARRY, 0 },
+	[BCS] = { FLAG_CARRY, 0 },
+	[BEQ] = { FLAG_ZERO, 0 },
+	[BIT] = { 0, FLAGS_NZ | FLAG_OVRF },
+	[BMI] = { FLAG_SIGN, 0 },
+	[BNE] = { FLAG_ZERO, 0 },
+	[BPL] = { FLAG_SIGN, 0 },
+	[BRK] = { 0xff, FLAG_IRQD },
+	[BVC] = { FLAG_OVRF, 0 },
+	[BVS] = { FLAG_OVRF, 0 },
+	[CLC] = { 0, FLAG_CARRY },
+	[CLD] = { 0, FLAG_BCD },
+	[CLI] = { 0, FLAG_IRQD },
+	[CLV] = { 0, FLAG_OVRF },
+	[CMP] = { 0, FLAGS_NZC },
+	[CPX] = { 0, FLAGS_NZC },
+	[CPY] = { 0, FLAGS_NZC },
+	[DEC] = { 0, FLAGS_NZ },
+	[DEX] = { 0, FLAGS_NZ },
+	[DEY] = { 0, FLAGS_NZ },
+	[EOR] = { 0, FLAGS_NZ },
+	[INC] = { 0, FLAGS_NZ },
+	[INX] = { 0, FLAGS_NZ },
+	[INY] = { 0, FLAGS_NZ },
+	[JMP] = { 0, 0 },
+	[JSR] = { 0, 0 },
+	[LDA] = { 0, FLAGS_NZ },
+	[LDX] = { 0, FLAGS_NZ },
+	[LDY] = { 0, FLAGS_NZ },
+	[LSR] = { 0, FLAGS_NZC },
+	[NOP] = { 0, 0 },
+	[ORA] = { 0, FLAGS_NZ },
+	[PHA] = { 0, 0 },
+	[PHP] = { 0xff, 0 },
+	[PLA] = { 0, FLAGS_NZ },
+	[PLP] = { 0, 0xff },
+	[ROL] = { FLAG_CARRY, FLAGS_NZC },
+	[ROR] = { FLAG_CARRY, FLAGS_NZC },
+	[RTI] = { 0, 0xff },
+	[RTS] = { 0, 0 },
+	[SBC] = { FLAG_CARRY | FLAG_BCD, FLAGS_NZCV },
+	[SEC] = { 0, FLAG_CARRY },
+	[SED] = { 0, FLAG_BCD },
+	[SEI] = { 0, FLAG_IRQD },
+	[STA] = { 0, 0 },
+	[STX] = { 0, 0 },
+	[STY] = { 0, 0 },
+	[TAX] = { 0, FLAGS_NZ },
+	[TAY] = { 0, FLAGS_NZ },
+	[TSX] = { 0, FLAGS_NZ },
+	[TXA] = { 0, FLAGS_NZ },
+	[TXS] = { 0, 0 },
+	[TYA] = { 0, FLAGS_NZ }
+};
+
 static const char *opcode_string[] = {
 	"ADC", "AND", "ASL", "BCC", "BCS", "BEQ", "BIT", "BMI",
 	"BNE", "BPL", "BRK", "BVC", "BVS", "CLC", "CLD", "CLI",
@@ -119,3 +187,90 @@ struct opinfo decode(u8 opcode)
 
 	return info;
 }
+
+u8 decode_length(u8 opcode)
+{
+	switch (decoder_table[opcode].mode) {
+		case mode_acc:
+		case mode_imp:
+			return 1;
+
+		case mode_abs:
+		case mode_abx:
+		case mode_aby:
+		case mode_ind:
+			return 3;
+
+		default:
+			return 2;
+	}
+}
+
+int decode_disasm(char *buf, size_t size, u16 pc, const u8 *bytes)
+{
+	const struct opinfo *info = &decoder_table[bytes[0]];
+	const char *name = opcode_string[info->opcode];
+	u16 abs = ((u16)bytes[2] << 8) | bytes[1];
+
+	if (info->opcode == NOP && bytes[0] != 0xea)
+		name = "???";
+
+	switch (info->mode) {
+		case mode_acc:
+			return snprintf(buf, size, "%s A", name);
+
+		case mode_abs:
+			return snprintf(buf, size, "%s $%04x", name, abs);
+
+		case mode_abx:
+			return snprintf(buf, size, "%s $%04x,X", name, abs);
+
+		case mode_aby:
+			return snprintf(buf, size, "%s $%04x,Y", name, abs);
+
+		case mode_imm:
+			return snprintf(buf, size, "%s #$%02x", name, bytes[1]);
+
+		case mode_ind:
+			return snprintf(buf, size, "%s ($%04x)", name, abs);
+
+		case mode_inx:
+			return snprintf(buf, size, "%s ($%02x,X)", name, bytes[1]);
+
+		case mode_iny:
+			return snprintf(buf, size, "%s ($%02x),Y", name, bytes[1]);
+
+		case mode_rel:
+			return snprintf(buf, size, "%s $%04x", name, (u16)(pc + 2 + (s8)bytes[1]));
+
+		case mode_zp:
+			return snprintf(buf, size, "%s $%02x", name, bytes[1]);
+
+		case mode_zpx:
+			return snprintf(buf, size, "%s $%02x,X", name, bytes[1]);
+
+		case mode_zpy:
+			return snprintf(buf, size, "%s $%02x,Y", name, bytes[1]);
+
+		default:
+			return snprintf(buf, size, "%s", name);
+	}
+}
+
+void decode_flags(enum opcode opcode, u8 *read, u8 *written)
+{
+	*read = flag_use[opcode].read;
+	*written = flag_use[opcode].written;
+}
+
+void decode_deadflags(const u8 *opcodes, unsigned int count, u8 *dead)
+{
+	u8 live = 0xff, read, written;
+
+	while (count-- > 0) {
+		decode_flags(decoder_table[opcodes[count]].opcode, &read, &written);
+
+		dead[count] = written & ~live;
+		live = (live & ~written) | read;
+	}
+}
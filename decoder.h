@@ -5,6 +5,7 @@
 #ifndef SIMAK65_DECODER_H_
 #define SIMAK65_DECODER_H_
 
+#include <stddef.h>
 #include "types.h"
 
 enum opcode {
@@ -29,8 +30,25 @@ struct opinfo {
 	enum addrmode mode;
 };
 
+/* Instruction and addressing mode of every opcode, undocumented ones are
+ * NOP */
+extern const struct opinfo decoder_table[256];
+
 struct opinfo decode(u8 opcode);
 
+/* Instruction length in bytes, including the opcode */
+u8 decode_length(u8 opcode);
+
+/* Format the instruction at pc, bytes holds the opcode and operands */
+int decode_disasm(char *buf, size_t size, u16 pc, const u8 *bytes);
+
 const char *opcodetostring(enum opcode opcode);
 
+/* Flags the instruction reads and sets */
+void decode_flags(enum opcode opcode, u8 *read, u8 *written);
+
+/* Mark the flags every instruction of a straight-line sequence sets that
+ * are set again before being read, all flags are live after the last one */
+void decode_deadflags(const u8 *opcodes, unsigned int count, u8 *dead);
+
 #endif /* SIMAK65_DECODER_H_ */
@@ -17,4 +17,16 @@ void exec_nmi(struct simak65_cpu *cpu);
 
 void exec_rst(struct simak65_cpu *cpu);
 
+/* Fused handler of frequent instruction sequences starting with an already
+ * fetched opcode, returns -1 once a whole sequence executed or the opcode
+ * fetched after the part that matched */
+typedef int (*exec_fuse_t)(struct simak65_cpu *cpu);
+
+/* Generated from the sequence profile at build time, NULL if none starts
+ * with the opcode */
+extern const exec_fuse_t exec_fuse[256];
+
+/* Return from subroutine as RTS does, without taking any cycles */
+void exec_return(struct simak65_cpu *cpu);
+
 #endif /* SIMAK65_EXEC_H_ */
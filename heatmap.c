@@ -0,0 +1,107 @@
+/* SimAK65 memory access heatmap
+ * Copyright A.K. 2026
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "error.h"
+#include "heatmap.h"
+#include "simak65.h"
+
+#define HEAT_MAGIC "SK65HEAT"
+#define HEAT_VERSION 1
+
+#define HEAT_FLAG_BYTES 0x01
+
+struct simak65_heatmap *simak65_heatmap_create(int bytes)
+{
+	struct simak65_heatmap *heat;
+
+	heat = calloc(1, sizeof(*heat));
+	if (heat == NULL)
+		return NULL;
+
+	if (bytes) {
+		heat->bytes = calloc(0x10000, sizeof(*heat->bytes));
+		if (heat->bytes == NULL) {
+			free(heat);
+			return NULL;
+		}
+	}
+
+	return heat;
+}
+
+void simak65_heatmap_destroy(struct simak65_heatmap *heat)
+{
+	if (heat == NULL)
+		return;
+
+	free(heat->bytes);
+	free(heat);
+}
+
+void simak65_heatmap_attach(struct simak65_cpu *cpu, struct simak65_heatmap *heat)
+{
+	cpu->heatmap = heat;
+}
+
+void simak65_heatmap_reset(struct simak65_heatmap *heat)
+{
+	memset(heat->pages, 0, sizeof(heat->pages));
+	memset(heat->classes, 0, sizeof(heat->classes));
+
+	if (heat->bytes != NULL)
+		memset(heat->bytes, 0, 0x10000 * sizeof(*heat->bytes));
+}
+
+static void heat_leb(FILE *f, uint64_t v)
+{
+	do {
+		fputc((v & 0x7f) | ((v > 0x7f) ? 0x80 : 0), f);
+		v >>= 7;
+	} while (v != 0);
+}
+
+int simak65_heatmap_write(const struct simak65_heatmap *heat, FILE *f)
+{
+	u8 touched[32] = { 0 };
+	unsigned int page, addr, kind;
+
+	for (page = 0; page < 256; ++page) {
+		for (kind = 0; kind < SIMAK65_HEAT_KINDS; ++kind) {
+			if (heat->pages[page][kind] != 0) {
+				touched[page >> 3] |= 1 << (page & 7);
+				break;
+			}
+		}
+	}
+
+	/* Header, bitmap of accessed pages, then for every accessed page its
+	 * counters, the class of each byte and optionally per byte counters.
+	 * Counters are LEB128. */
+	fwrite(HEAT_MAGIC, 1, strlen(HEAT_MAGIC), f);
+	fputc(HEAT_VERSION, f);
+	fputc((heat->bytes != NULL) ? HEAT_FLAG_BYTES : 0, f);
+	fwrite(touched, 1, sizeof(touched), f);
+
+	for (page = 0; page < 256; ++page) {
+		if (!(touched[page >> 3] & (1 << (page & 7))))
+			continue;
+
+		for (kind = 0; kind < SIMAK65_HEAT_KINDS; ++kind)
+			heat_leb(f, heat->pages[page][kind]);
+
+		fwrite(&heat->classes[page << 8], 1, 256, f);
+
+		if (heat->bytes == NULL)
+			continue;
+
+		for (addr = page << 8; addr < (page + 1) << 8; ++addr) {
+			for (kind = 0; kind < SIMAK65_HEAT_KINDS; ++kind)
+				heat_leb(f, heat->bytes[addr][kind]);
+		}
+	}
+
+	return ferror(f) ? -1 : 0;
+}
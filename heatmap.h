@@ -0,0 +1,20 @@
+/* SimAK65 memory access heatmap
+ * Copyright A.K. 2026
+ */
+
+#ifndef SIMAK65_HEATMAP_H_
+#define SIMAK65_HEATMAP_H_
+
+#include "types.h"
+#include "simak65.h"
+
+static inline void heatmap_count(struct simak65_heatmap *heat, u16 addr, enum simak65_heat kind, u8 cls)
+{
+	heat->pages[addr >> 8][kind]++;
+	heat->classes[addr] |= cls;
+
+	if (heat->bytes != NULL)
+		heat->bytes[addr][kind]++;
+}
+
+#endif /* SIMAK65_HEATMAP_H_ */
@@ -0,0 +1,51 @@
+/* SimAK65 per-instruction hooks
+ * Copyright A.K. 2026
+ */
+
+#ifndef SIMAK65_HOOK_H_
+#define SIMAK65_HOOK_H_
+
+#include <limits.h>
+#include "simak65.h"
+#include "sampler.h"
+
+/* Features doing work around every instruction, any of them set moves
+ * simak65_step() off the fast path */
+#define HOOK_LOG       0x01
+#define HOOK_REVERSE   0x02
+#define HOOK_TRACE     0x04
+#define HOOK_TRACEFILE 0x08
+#define HOOK_PROFILE   0x10
+/* The sampler only leaves the fast path once its countdown expires */
+#define HOOK_SAMPLER   0x20
+/* Set while a call is recorded for the subroutine cache */
+#define HOOK_MEMO      0x80
+
+/* Recompute the cycle simak65_step() leaves the fast path at. Racing with
+ * another thread at worst delays a newly set hook until the next sample. */
+static inline void hook_update(struct simak65_cpu *cpu)
+{
+	unsigned int hooks = __atomic_load_n(&cpu->hooks, __ATOMIC_ACQUIRE);
+	unsigned long at;
+
+	if ((hooks & ~HOOK_SAMPLER) != 0)
+		at = 0;
+	else if (hooks != 0)
+		at = (cpu->sampler->next > SAMPLER_LEAD) ? cpu->sampler->next - SAMPLER_LEAD : 0;
+	else
+		at = ULONG_MAX;
+
+	__atomic_store_n(&cpu->hook_at, at, __ATOMIC_RELEASE);
+}
+
+static inline void hook_set(struct simak65_cpu *cpu, unsigned int hook, int enable)
+{
+	if (enable)
+		__atomic_fetch_or(&cpu->hooks, hook, __ATOMIC_RELEASE);
+	else
+		__atomic_fetch_and(&cpu->hooks, ~hook, __ATOMIC_RELEASE);
+
+	hook_update(cpu);
+}
+
+#endif /* SIMAK65_HOOK_H_ */
@@ -0,0 +1,206 @@
+/* SimAK65 block copy and fill loop recognition
+ * Copyright A.K. 2026
+ *
+ * Recognised loops, the index register counting towards zero:
+ *
+ *   loop: LDA src     loop: STA dst
+ *         STA dst           INY/DEY/INX/DEX
+ *         INY/DEY/INX/DEX   BNE loop
+ *         BNE loop
+ *
+ * with src and dst being (zp),Y, abs,Y or abs,X indexed by the counted
+ * register. The first pass through the BNE arms the loop, the second one
+ * measures the cycles and counters of an iteration. All iterations but the
+ * last are then done with a single memcpy or memset over the RAM, the last
+ * one is executed to leave exactly the same state as iterating would. Within
+ * simak65_run() no more iterations are skipped than fit before its end or a
+ * due hook, a single simak65_step() outside of it may skip up to 254.
+ */
+
+#include <string.h>
+#include "error.h"
+#include "idiom.h"
+#include "flags.h"
+#include "bus.h"
+#include "simak65.h"
+
+#define IDIOM_X 1
+#define IDIOM_Y 2
+
+#define IDIOM_LDA 0xa0
+#define IDIOM_STA 0x80
+
+struct idiom_ref {
+	u16 addr;
+	u8 index;
+	/* Zero page pointer, if indirect */
+	int zp;
+};
+
+/* Decode a LDA or STA indexed access at pc, returns its length or 0 */
+static unsigned int idiom_ref(const u8 *ram, u16 pc, u8 op, struct idiom_ref *ref)
+{
+	u8 zp;
+
+	ref->zp = -1;
+
+	if (ram[pc] == (op | 0x11)) {
+		/* (zp),Y */
+		zp = ram[(u16)(pc + 1)];
+		ref->addr = ram[zp] | ((u16)ram[(u8)(zp + 1)] << 8);
+		ref->index = IDIOM_Y;
+		ref->zp = zp;
+		return 2;
+	}
+
+	if (ram[pc] == (op | 0x19) || ram[pc] == (op | 0x1d)) {
+		/* abs,Y and abs,X */
+		ref->addr = ram[(u16)(pc + 1)] | ((u16)ram[(u16)(pc + 2)] << 8);
+		ref->index = (ram[pc] & 0x04) ? IDIOM_X : IDIOM_Y;
+		return 3;
+	}
+
+	return 0;
+}
+
+static int idiom_overlap(u32 a, u32 alen, u32 b, u32 blen)
+{
+	return a < b + blen && b < a + alen;
+}
+
+static int idiom_io(const struct simak65_cpu *cpu, u32 start, u32 len)
+{
+	u32 page;
+
+	for (page = start >> 8; page <= (start + len - 1) >> 8; ++page) {
+		if (bus_isio(cpu, page << 8))
+			return 1;
+	}
+
+	return 0;
+}
+
+/* The pointer of an indirect access must survive the writes */
+static int idiom_hitszp(const struct idiom_ref *ref, u32 dst, u32 len)
+{
+	return ref->zp >= 0 && (idiom_overlap(ref->zp, 1, dst, len) || idiom_overlap((u8)(ref->zp + 1), 1, dst, len));
+}
+
+void idiom_loop(struct simak65_cpu *cpu, u16 branch)
+{
+	const u8 *ram = cpu->ram;
+	struct idiom_ref src, dst;
+	u16 head = cpu->reg.pc, pc = head;
+	u8 *reg, index, first, last, lo;
+	u32 n, len, from, to, page;
+	uint64_t *perf;
+	const uint64_t *delta;
+	unsigned long cycles, limit;
+	unsigned int i, copy;
+	int step;
+
+	/* Every skipped instruction has to be invisible */
+	if (__atomic_load_n(&cpu->hooks, __ATOMIC_RELAXED) != 0 || cpu->breakpoints != NULL || cpu->watch_read != NULL ||
+			cpu->watch_write != NULL || cpu->heatmap != NULL || cpu->memo_rec != NULL)
+		return;
+
+	copy = (ram[pc] & 0xe0) == IDIOM_LDA;
+	if (copy) {
+		if ((i = idiom_ref(ram, pc, IDIOM_LDA, &src)) == 0)
+			return;
+		pc += i;
+	}
+
+	if ((i = idiom_ref(ram, pc, IDIOM_STA, &dst)) == 0)
+		return;
+	pc += i;
+
+	switch (ram[pc]) {
+		case 0xc8: index = IDIOM_Y; step = 1; break;
+		case 0x88: index = IDIOM_Y; step = -1; break;
+		case 0xe8: index = IDIOM_X; step = 1; break;
+		case 0xca: index = IDIOM_X; step = -1; break;
+		default: return;
+	}
+
+	if (++pc != branch || dst.index != index || (copy && src.index != index))
+		return;
+
+	reg = (index == IDIOM_X) ? &cpu->reg.x : &cpu->reg.y;
+
+	/* Measure one iteration first */
+	if (!cpu->idiom.armed || cpu->idiom.branch != branch || (u8)(cpu->idiom.index + step) != *reg) {
+		cpu->idiom.armed = 1;
+		cpu->idiom.branch = branch;
+		cpu->idiom.index = *reg;
+		cpu->idiom.cycles = cpu->cycles;
+		cpu->idiom.perf = cpu->perf;
+		return;
+	}
+
+	cpu->idiom.armed = 0;
+
+	/* Iterations left but the last one, the index isn't zero here */
+	n = ((step > 0) ? 0x100 - *reg : *reg) - 1;
+
+	/* No further than iterating would run before the run ends or a hook
+	 * is due, the rest is iterated or skipped once armed again */
+	cycles = cpu->cycles - cpu->idiom.cycles;
+	limit = __atomic_load_n(&cpu->hook_at, __ATOMIC_RELAXED);
+	if (cpu->idiom.end < limit)
+		limit = cpu->idiom.end;
+	if (cpu->cycles >= limit)
+		return;
+	if ((limit - cpu->cycles) / cycles < n)
+		n = (limit - cpu->cycles) / cycles;
+	if (n == 0)
+		return;
+
+	first = *reg;
+	last = first + step * (int)(n - 1);
+	lo = (step > 0) ? first : last;
+	len = n;
+
+	from = (u32)src.addr + lo;
+	to = (u32)dst.addr + lo;
+
+	if (to + len > 0x10000 || idiom_io(cpu, to, len) || idiom_overlap(to, len, head, branch + 2 - head) ||
+			idiom_hitszp(&dst, to, len))
+		return;
+
+	if (copy && (from + len > 0x10000 || idiom_io(cpu, from, len) || idiom_overlap(from, len, to, len) ||
+			idiom_hitszp(&src, to, len)))
+		return;
+
+	DEBUG("Block %s loop at 0x%04x, %u iterations", copy ? "copy" : "fill", head, n);
+
+	if (copy) {
+		memcpy(cpu->ram + to, cpu->ram + from, len);
+		cpu->reg.a = ram[(u16)(src.addr + last)];
+	}
+	else {
+		memset(cpu->ram + to, cpu->reg.a, len);
+	}
+
+	for (page = to >> 8; page <= (to + len - 1) >> 8; ++page)
+		bus_dirty(cpu, page << 8);
+
+	/* Counting leaves the index non-zero, last set by INY/DEY/INX/DEX */
+	*reg = last + step;
+	cpu->reg.flags &= ~(FLAG_SIGN | FLAG_ZERO);
+	cpu->reg.flags |= *reg & FLAG_SIGN;
+
+	cpu->cycles += n * cycles;
+
+	/* The counters are all uint64_t */
+	perf = (uint64_t *)&cpu->perf;
+	delta = (const uint64_t *)&cpu->idiom.perf;
+	for (i = 0; i < sizeof(cpu->perf) / sizeof(uint64_t); ++i)
+		perf[i] += n * (perf[i] - delta[i]);
+}
+
+void simak65_ram(struct simak65_cpu *cpu, uint8_t *ram)
+{
+	idiom_reset(cpu);
+	cpu->ram = ram;
+}
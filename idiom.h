@@ -0,0 +1,20 @@
+/* SimAK65 block copy and fill loop recognition
+ * Copyright A.K. 2026
+ */
+
+#ifndef SIMAK65_IDIOM_H_
+#define SIMAK65_IDIOM_H_
+
+#include "types.h"
+#include "simak65.h"
+
+/* Called after BNE branched back to pc, branch is the address of the BNE */
+void idiom_loop(struct simak65_cpu *cpu, u16 branch);
+
+/* Forget the loop being measured, on interrupts and state changes */
+static inline void idiom_reset(struct simak65_cpu *cpu)
+{
+	cpu->idiom.armed = 0;
+}
+
+#endif /* SIMAK65_IDIOM_H_ */
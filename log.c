@@ -0,0 +1,315 @@
+/* SimAK65 bus input log
+ * Copyright A.K. 2026
+ *
+ * Only nondeterministic input is logged: values read from I/O pages and
+ * cycle stamps of interrupt delivery. Reads are stored as a raw byte, 0xff
+ * is an escape followed by 0x00 for a read of 0xff, or by the event type
+ * and an absolute cycle stamp encoded as LEB128.
+ */
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include "error.h"
+#include "log.h"
+#include "exec.h"
+#include "hook.h"
+#include "simak65.h"
+
+#define LOG_MAGIC "SK65"
+#define LOG_VERSION 1
+#define LOG_HEADER_SIZE 5
+
+#define LOG_ESCAPE 0xff
+
+static void log_fetch(struct simak65_log *log)
+{
+	int c, shift = 0;
+
+	log->next.event = log_eof;
+	log->next.len = 1;
+
+	if (log->pos >= log->end)
+		return;
+
+	c = getc_unlocked(log->f);
+	if (c == EOF)
+		return;
+
+	if (c != LOG_ESCAPE) {
+		log->next.event = log_read;
+		log->next.value = c;
+		return;
+	}
+
+	c = getc_unlocked(log->f);
+	++log->next.len;
+
+	if (c == 0) {
+		log->next.event = log_read;
+		log->next.value = LOG_ESCAPE;
+		return;
+	}
+
+	if (c != log_irq && c != log_nmi) {
+		WARN("Corrupted log at offset %lu", log->pos);
+		log->error = 1;
+		return;
+	}
+
+	log->next.event = c;
+	log->next.stamp = 0;
+
+	do {
+		c = getc_unlocked(log->f);
+		++log->next.len;
+
+		if (c == EOF) {
+			log->next.event = log_eof;
+			return;
+		}
+
+		if (shift >= (int)(sizeof(log->next.stamp) * CHAR_BIT)) {
+			WARN("Corrupted log at offset %lu: cycle stamp too long", log->pos);
+			log->next.event = log_eof;
+			log->error = 1;
+			return;
+		}
+
+		log->next.stamp |= (unsigned long)(c & 0x7f) << shift;
+		shift += 7;
+	} while (c & 0x80);
+}
+
+static void log_consume(struct simak65_log *log)
+{
+	log->pos += log->next.len;
+	log_fetch(log);
+}
+
+static void log_put(struct simak65_log *log, u8 byte)
+{
+	if (putc_unlocked(byte, log->f) == EOF && !log->error) {
+		WARN("Log write failed");
+		log->error = 1;
+	}
+
+	++log->pos;
+}
+
+static void log_desync(struct simak65_cpu *cpu, const char *what)
+{
+	if (!cpu->log->error)
+		WARN("Replay out of sync at cycle %lu: %s", cpu->cycles, what);
+
+	cpu->log->error = 1;
+}
+
+u8 log_ioread(struct simak65_cpu *cpu, u16 addr)
+{
+	struct simak65_log *log = cpu->log;
+	u8 data;
+
+	if (log->mode == log_replay) {
+		if (log->next.event != log_read) {
+			log_desync(cpu, "unexpected read");
+			return cpu->bus.read(addr);
+		}
+
+		data = log->next.value;
+		log_consume(log);
+
+		return data;
+	}
+
+	data = cpu->bus.read(addr);
+
+	log_put(log, data);
+	if (data == LOG_ESCAPE)
+		log_put(log, 0);
+
+	return data;
+}
+
+void log_iowrite(struct simak65_cpu *cpu, u16 addr, u8 data)
+{
+	/* Devices are absent during replay */
+	if (cpu->log->mode != log_replay)
+		cpu->bus.write(addr, data);
+}
+
+int log_interrupt(struct simak65_cpu *cpu, enum log_event event)
+{
+	struct simak65_log *log = cpu->log;
+	unsigned long stamp = cpu->cycles;
+
+	/* Replayed interrupts come from the log only */
+	if (log->mode == log_replay) {
+		WARN("%s at cycle %lu ignored during replay", (event == log_irq) ? "IRQ" : "NMI", cpu->cycles);
+		return -1;
+	}
+
+	log_put(log, LOG_ESCAPE);
+	log_put(log, event);
+
+	do {
+		log_put(log, (stamp & 0x7f) | ((stamp > 0x7f) ? 0x80 : 0));
+		stamp >>= 7;
+	} while (stamp != 0);
+
+	return 0;
+}
+
+void log_step(struct simak65_cpu *cpu)
+{
+	struct simak65_log *log = cpu->log;
+
+	if (log->mode != log_replay)
+		return;
+
+	while ((log->next.event == log_irq || log->next.event == log_nmi) && log->next.stamp <= cpu->cycles) {
+		if (log->next.stamp != cpu->cycles)
+			log_desync(cpu, "missed interrupt");
+
+		if (log->next.event == log_irq)
+			exec_irq(cpu);
+		else
+			exec_nmi(cpu);
+
+		log_consume(log);
+	}
+}
+
+int log_seek(struct simak65_log *log, unsigned long pos)
+{
+	if (log->mode == log_record && fflush(log->f) != 0)
+		return -1;
+
+	if (fseek(log->f, pos, SEEK_SET) != 0)
+		return -1;
+
+	log->mode = log_replay;
+	log->pos = pos;
+	log_fetch(log);
+
+	return 0;
+}
+
+int log_resume(struct simak65_log *log)
+{
+	if (log->mode == log_record)
+		return 0;
+
+	if (fseek(log->f, log->pos, SEEK_SET) != 0)
+		return -1;
+
+	log->mode = log_record;
+
+	return 0;
+}
+
+static int log_start(struct simak65_cpu *cpu, FILE *f, enum log_mode mode)
+{
+	struct simak65_log *log;
+
+	if (cpu->log != NULL)
+		simak65_log_stop(cpu);
+
+	log = malloc(sizeof(*log));
+	if (log == NULL)
+		return -1;
+
+	log->f = f;
+	log->mode = mode;
+	log->error = 0;
+	log->pos = LOG_HEADER_SIZE;
+	log->end = ULONG_MAX;
+
+	cpu->log = log;
+	hook_set(cpu, HOOK_LOG, 1);
+
+	return 0;
+}
+
+int simak65_record(struct simak65_cpu *cpu, FILE *f)
+{
+	if (fwrite(LOG_MAGIC, 1, 4, f) != 4 || putc(LOG_VERSION, f) == EOF)
+		return -1;
+
+	return log_start(cpu, f, log_record);
+}
+
+static int log_header(FILE *f)
+{
+	char header[LOG_HEADER_SIZE];
+
+	if (fread(header, 1, sizeof(header), f) != sizeof(header) ||
+			memcmp(header, LOG_MAGIC, 4) != 0 || header[4] != LOG_VERSION) {
+		WARN("Invalid log header");
+		return -1;
+	}
+
+	return 0;
+}
+
+int log_open(struct simak65_cpu *cpu, FILE *f)
+{
+	if (log_header(f) < 0 || log_start(cpu, f, log_replay) < 0)
+		return -1;
+
+	/* Nothing to replay before the first segment */
+	cpu->log->next.event = log_eof;
+
+	return 0;
+}
+
+int log_segment(struct simak65_log *log, unsigned long pos, unsigned long end)
+{
+	log->end = end;
+	log->error = 0;
+
+	return log_seek(log, pos);
+}
+
+int simak65_replay(struct simak65_cpu *cpu, FILE *f)
+{
+	if (log_header(f) < 0 || log_start(cpu, f, log_replay) < 0)
+		return -1;
+
+	log_fetch(cpu->log);
+	log_step(cpu);
+
+	return 0;
+}
+
+int simak65_log_stop(struct simak65_cpu *cpu)
+{
+	struct simak65_log *log = cpu->log;
+	int err;
+
+	if (log == NULL)
+		return 0;
+
+	if (log->mode == log_record && fflush(log->f) != 0)
+		log->error = 1;
+
+	err = log->error ? -1 : 0;
+
+	free(log);
+	hook_set(cpu, HOOK_LOG, 0);
+	cpu->log = NULL;
+
+	return err;
+}
+
+void simak65_io(struct simak65_cpu *cpu, uint16_t start, uint16_t end, int io)
+{
+	unsigned int page;
+
+	for (page = start >> 8; page <= (unsigned int)(end >> 8); ++page) {
+		if (io)
+			cpu->io[page >> 5] |= (u32)1 << (page & 0x1f);
+		else
+			cpu->io[page >> 5] &= ~((u32)1 << (page & 0x1f));
+	}
+}
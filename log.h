@@ -0,0 +1,58 @@
+/* SimAK65 bus input log
+ * Copyright A.K. 2026
+ */
+
+#ifndef SIMAK65_LOG_H_
+#define SIMAK65_LOG_H_
+
+#include <stdio.h>
+#include "types.h"
+#include "simak65.h"
+
+enum log_mode { log_record, log_replay };
+
+enum log_event { log_read, log_irq, log_nmi, log_eof };
+
+struct simak65_log {
+	FILE *f;
+	enum log_mode mode;
+	int error;
+
+	/* Stream offset of the next record and of the replay end */
+	unsigned long pos;
+	unsigned long end;
+
+	/* Next record to be replayed */
+	struct {
+		enum log_event event;
+		u8 value;
+		unsigned long stamp;
+		unsigned int len;
+	} next;
+};
+
+u8 log_ioread(struct simak65_cpu *cpu, u16 addr);
+
+void log_iowrite(struct simak65_cpu *cpu, u16 addr, u8 data);
+
+/* Returns 0 if the interrupt should be executed */
+int log_interrupt(struct simak65_cpu *cpu, enum log_event event);
+
+/* Deliver interrupts recorded up to the current cycle */
+void log_step(struct simak65_cpu *cpu);
+
+/* Switch to replaying from the stream offset */
+int log_seek(struct simak65_log *log, unsigned long pos);
+
+/* Switch from replaying to recording at the current offset */
+int log_resume(struct simak65_log *log);
+
+/* Attach a log for replaying segments of it, nothing is replayed until
+ * log_segment() */
+int log_open(struct simak65_cpu *cpu, FILE *f);
+
+/* Replay from the stream offset up to end, the state at pos has to be
+ * loaded before the next log_step() */
+int log_segment(struct simak65_log *log, unsigned long pos, unsigned long end);
+
+#endif /* SIMAK65_LOG_H_ */
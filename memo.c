@@ -0,0 +1,476 @@
+/* SimAK65 subroutine memoization
+ * Copyright A.K. 2026
+ *
+ * The first calls of every JSR target are recorded: registers and flags
+ * used before being set, the first value read from every address
+ * (instruction bytes included) and the last value written to every
+ * address. A later call with the same inputs that would read the same
+ * values executes exactly the same way, so its writes, registers and
+ * cycles are taken from the cache.
+ * Routines touching I/O pages, modifying their own code or not returning
+ * where they were called from are never cached.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "error.h"
+#include "memo.h"
+#include "exec.h"
+#include "bus.h"
+#include "hook.h"
+#include "flags.h"
+#include "simak65.h"
+
+#define MEMO_ENTRIES 8
+#define MEMO_READS   64
+#define MEMO_WRITES  32
+
+/* Address marks while recording */
+#define MEMO_READ    0x01
+#define MEMO_WRITTEN 0x02
+#define MEMO_FETCHED 0x04
+#define MEMO_RET     0x08
+
+/* Registers */
+#define MEMO_A 0x01
+#define MEMO_X 0x02
+#define MEMO_Y 0x04
+
+/* Registers used and set by every instruction */
+static const struct {
+	u8 rregs, wregs;
+} memo_use[] = {
+	[ADC] = { MEMO_A, MEMO_A },
+	[AND] = { MEMO_A, MEMO_A },
+	[ASL] = { 0, 0 },
+	[BCC] = { 0, 0 },
+	[BCS] = { 0, 0 },
+	[BEQ] = { 0, 0 },
+	[BIT] = { MEMO_A, 0 },
+	[BMI] = { 0, 0 },
+	[BNE] = { 0, 0 },
+	[BPL] = { 0, 0 },
+	[BRK] = { 0, 0 },
+	[BVC] = { 0, 0 },
+	[BVS] = { 0, 0 },
+	[CLC] = { 0, 0 },
+	[CLD] = { 0, 0 },
+	[CLI] = { 0, 0 },
+	[CLV] = { 0, 0 },
+	[CMP] = { MEMO_A, 0 },
+	[CPX] = { MEMO_X, 0 },
+	[CPY] = { MEMO_Y, 0 },
+	[DEC] = { 0, 0 },
+	[DEX] = { MEMO_X, MEMO_X },
+	[DEY] = { MEMO_Y, MEMO_Y },
+	[EOR] = { MEMO_A, MEMO_A },
+	[INC] = { 0, 0 },
+	[INX] = { MEMO_X, MEMO_X },
+	[INY] = { MEMO_Y, MEMO_Y },
+	[JMP] = { 0, 0 },
+	[JSR] = { 0, 0 },
+	[LDA] = { 0, MEMO_A },
+	[LDX] = { 0, MEMO_X },
+	[LDY] = { 0, MEMO_Y },
+	[LSR] = { 0, 0 },
+	[NOP] = { 0, 0 },
+	[ORA] = { MEMO_A, MEMO_A },
+	[PHA] = { MEMO_A, 0 },
+	[PHP] = { 0, 0 },
+	[PLA] = { 0, MEMO_A },
+	[PLP] = { 0, 0 },
+	[ROL] = { 0, 0 },
+	[ROR] = { 0, 0 },
+	[RTI] = { 0, 0 },
+	[RTS] = { 0, 0 },
+	[SBC] = { MEMO_A, MEMO_A },
+	[SEC] = { 0, 0 },
+	[SED] = { 0, 0 },
+	[SEI] = { 0, 0 },
+	[STA] = { MEMO_A, 0 },
+	[STX] = { MEMO_X, 0 },
+	[STY] = { MEMO_Y, 0 },
+	[TAX] = { MEMO_A, MEMO_X },
+	[TAY] = { MEMO_A, MEMO_Y },
+	[TSX] = { 0, MEMO_X },
+	[TXA] = { MEMO_X, MEMO_A },
+	[TXS] = { MEMO_X, 0 },
+	[TYA] = { MEMO_Y, MEMO_A }
+};
+
+struct memo_access {
+	u16 addr;
+	u8 data;
+};
+
+struct memo_entry {
+	/* Registers on entry, only the used ones are compared */
+	u8 a, x, y, sp, flags;
+	u8 regs, flagsmask;
+	/* Registers on return, only the set ones are updated */
+	u8 ra, rx, ry, rflags;
+	u8 wregs, wflagsmask;
+	u8 nreads;
+	u8 nwrites;
+	unsigned long cycles;
+	struct memo_access reads[MEMO_READS];
+	struct memo_access writes[MEMO_WRITES];
+};
+
+struct memo_routine {
+	uint64_t calls;
+	uint64_t hits;
+	int impure;
+	unsigned int count;
+	unsigned int next;
+	struct memo_entry entries[MEMO_ENTRIES];
+};
+
+struct simak65_memo {
+	struct memo_routine *routines[0x10000];
+
+	/* Call being recorded */
+	struct {
+		struct memo_routine *routine;
+		u16 addr;
+		u16 ret;
+		u8 sp;
+		unsigned int retreads;
+		unsigned long cycles;
+		struct memo_entry entry;
+	} rec;
+	u8 marks[0x10000];
+};
+
+struct simak65_memo *simak65_memo_create(void)
+{
+	return calloc(1, sizeof(struct simak65_memo));
+}
+
+void simak65_memo_reset(struct simak65_memo *memo)
+{
+	unsigned int i;
+
+	for (i = 0; i < 0x10000; ++i) {
+		free(memo->routines[i]);
+		memo->routines[i] = NULL;
+	}
+}
+
+void simak65_memo_destroy(struct simak65_memo *memo)
+{
+	if (memo == NULL)
+		return;
+
+	simak65_memo_reset(memo);
+	free(memo);
+}
+
+void simak65_memo_attach(struct simak65_cpu *cpu, struct simak65_memo *memo)
+{
+	memo_abort(cpu);
+	cpu->memo = memo;
+}
+
+static void memo_stop(struct simak65_cpu *cpu)
+{
+	struct simak65_memo *memo = cpu->memo_rec;
+	struct memo_entry *e = &memo->rec.entry;
+	unsigned int i;
+
+	for (i = 0; i < e->nreads; ++i)
+		memo->marks[e->reads[i].addr] = 0;
+
+	for (i = 0; i < e->nwrites; ++i)
+		memo->marks[e->writes[i].addr] = 0;
+
+	memo->marks[0x100 | memo->rec.sp] = 0;
+	memo->marks[0x100 | (u8)(memo->rec.sp - 1)] = 0;
+
+	cpu->memo_rec = NULL;
+	hook_set(cpu, HOOK_MEMO, 0);
+}
+
+void memo_fail(struct simak65_cpu *cpu, const char *reason)
+{
+	struct simak65_memo *memo = cpu->memo_rec;
+
+	(void)reason;
+
+	DEBUG("Not caching routine at 0x%04x: %s", memo->rec.addr, reason);
+
+	memo->rec.routine->impure = 1;
+	memo_stop(cpu);
+}
+
+void memo_abort(struct simak65_cpu *cpu)
+{
+	if (cpu->memo_rec != NULL)
+		memo_stop(cpu);
+}
+
+static int memo_match(struct simak65_cpu *cpu, const struct memo_entry *e)
+{
+	unsigned int i;
+
+	if (e->sp != cpu->reg.sp || ((e->flags ^ cpu->reg.flags) & e->flagsmask))
+		return 0;
+
+	if (((e->regs & MEMO_A) && e->a != cpu->reg.a) || ((e->regs & MEMO_X) && e->x != cpu->reg.x) ||
+			((e->regs & MEMO_Y) && e->y != cpu->reg.y))
+		return 0;
+
+	for (i = 0; i < e->nreads; ++i) {
+		if (bus_isio(cpu, e->reads[i].addr) || cpu->bus.read(e->reads[i].addr) != e->reads[i].data)
+			return 0;
+	}
+
+	return 1;
+}
+
+static void memo_apply(struct simak65_cpu *cpu, const struct memo_entry *e)
+{
+	unsigned int i;
+
+	for (i = 0; i < e->nwrites; ++i)
+		bus_write(cpu, e->writes[i].addr, e->writes[i].data);
+
+	if (e->wregs & MEMO_A)
+		cpu->reg.a = e->ra;
+	if (e->wregs & MEMO_X)
+		cpu->reg.x = e->rx;
+	if (e->wregs & MEMO_Y)
+		cpu->reg.y = e->ry;
+	cpu->reg.flags = (cpu->reg.flags & ~e->wflagsmask) | (e->rflags & e->wflagsmask);
+	cpu->cycles += e->cycles;
+
+	exec_return(cpu);
+}
+
+void memo_call(struct simak65_cpu *cpu, u8 sp, u16 ret)
+{
+	struct simak65_memo *memo = cpu->memo;
+	struct memo_routine *r;
+	struct memo_entry *e;
+	unsigned int i;
+
+	/* Calls made by a recorded routine are part of it */
+	if (cpu->memo_rec != NULL)
+		return;
+
+	r = memo->routines[cpu->reg.pc];
+	if (r == NULL) {
+		r = malloc(sizeof(*r));
+		if (r == NULL)
+			return;
+
+		r->calls = 0;
+		r->hits = 0;
+		r->impure = 0;
+		r->count = 0;
+		r->next = 0;
+		memo->routines[cpu->reg.pc] = r;
+	}
+
+	r->calls++;
+
+	if (r->impure)
+		return;
+
+	/* A cached call would skip the breakpoints and watchpoints inside the
+	 * routine and count as a single step for the per-instruction features,
+	 * it is still recorded */
+	if (__atomic_load_n(&cpu->hooks, __ATOMIC_RELAXED) == 0 && cpu->breakpoints == NULL &&
+			cpu->watch_read == NULL && cpu->watch_write == NULL) {
+		for (i = 0; i < r->count; ++i) {
+			if (memo_match(cpu, &r->entries[i])) {
+				DEBUG("Routine at 0x%04x answered from cache", cpu->reg.pc);
+				r->hits++;
+				memo_apply(cpu, &r->entries[i]);
+				return;
+			}
+		}
+	}
+
+	memo->rec.routine = r;
+	memo->rec.addr = cpu->reg.pc;
+	memo->rec.ret = ret;
+	memo->rec.sp = sp;
+	memo->rec.retreads = 0;
+	memo->rec.cycles = cpu->cycles;
+
+	e = &memo->rec.entry;
+	e->a = cpu->reg.a;
+	e->x = cpu->reg.x;
+	e->y = cpu->reg.y;
+	e->sp = cpu->reg.sp;
+	e->flags = cpu->reg.flags;
+	e->regs = 0;
+	e->flagsmask = 0;
+	e->wregs = 0;
+	e->wflagsmask = 0;
+	e->nreads = 0;
+	e->nwrites = 0;
+
+	/* Return address, read back only by the final RTS */
+	memo->marks[0x100 | sp] = MEMO_RET;
+	memo->marks[0x100 | (u8)(sp - 1)] = MEMO_RET;
+
+	cpu->memo_rec = memo;
+	hook_set(cpu, HOOK_MEMO, 1);
+}
+
+void memo_insn(struct simak65_cpu *cpu, enum opcode opcode, enum addrmode mode)
+{
+	struct memo_entry *e = &cpu->memo_rec->rec.entry;
+	u8 rregs = memo_use[opcode].rregs, wregs = memo_use[opcode].wregs;
+	u8 rflags, wflags;
+
+	if (mode == mode_acc) {
+		rregs |= MEMO_A;
+		wregs |= MEMO_A;
+	}
+	else if (mode == mode_abx || mode == mode_zpx || mode == mode_inx) {
+		rregs |= MEMO_X;
+	}
+	else if (mode == mode_aby || mode == mode_zpy || mode == mode_iny) {
+		rregs |= MEMO_Y;
+	}
+
+	/* Inputs are the registers and flags used before being set */
+	e->regs |= rregs & ~e->wregs;
+	e->wregs |= wregs;
+	decode_flags(opcode, &rflags, &wflags);
+	e->flagsmask |= rflags & ~e->wflagsmask;
+	e->wflagsmask |= wflags;
+}
+
+void memo_return(struct simak65_cpu *cpu)
+{
+	struct simak65_memo *memo = cpu->memo_rec;
+	struct memo_routine *r = memo->rec.routine;
+	struct memo_entry *e = &memo->rec.entry;
+
+	/* Return from a nested call */
+	if (cpu->reg.sp != memo->rec.sp)
+		return;
+
+	if (cpu->reg.pc != memo->rec.ret || memo->rec.retreads != 2) {
+		memo_fail(cpu, "return address used");
+		return;
+	}
+
+	e->ra = cpu->reg.a;
+	e->rx = cpu->reg.x;
+	e->ry = cpu->reg.y;
+	e->rflags = cpu->reg.flags;
+	e->cycles = cpu->cycles - memo->rec.cycles;
+
+	if (r->count < MEMO_ENTRIES) {
+		r->entries[r->count++] = *e;
+	}
+	else {
+		r->entries[r->next] = *e;
+		r->next = (r->next + 1) % MEMO_ENTRIES;
+	}
+
+	memo_stop(cpu);
+}
+
+void memo_read(struct simak65_cpu *cpu, u16 addr, u8 data, int fetch)
+{
+	struct simak65_memo *memo = cpu->memo_rec;
+	struct memo_entry *e = &memo->rec.entry;
+	u8 mark = memo->marks[addr];
+
+	if (bus_isio(cpu, addr)) {
+		memo_fail(cpu, "I/O read");
+		return;
+	}
+
+	if (mark & MEMO_RET) {
+		memo->rec.retreads++;
+		return;
+	}
+
+	if (fetch && (mark & MEMO_WRITTEN)) {
+		memo_fail(cpu, "self-modifying code");
+		return;
+	}
+
+	/* Only the values from before the call are inputs */
+	if (!(mark & (MEMO_READ | MEMO_WRITTEN))) {
+		if (e->nreads == MEMO_READS) {
+			memo_fail(cpu, "too many reads");
+			return;
+		}
+
+		e->reads[e->nreads].addr = addr;
+		e->reads[e->nreads].data = data;
+		e->nreads++;
+		memo->marks[addr] |= MEMO_READ;
+	}
+
+	/* Fetched addresses are all in the read list, cleared with it */
+	if (fetch)
+		memo->marks[addr] |= MEMO_FETCHED;
+}
+
+void memo_write(struct simak65_cpu *cpu, u16 addr, u8 data)
+{
+	struct simak65_memo *memo = cpu->memo_rec;
+	struct memo_entry *e = &memo->rec.entry;
+	u8 mark = memo->marks[addr];
+	unsigned int i;
+
+	if (bus_isio(cpu, addr)) {
+		memo_fail(cpu, "I/O write");
+		return;
+	}
+
+	if (mark & (MEMO_FETCHED | MEMO_RET)) {
+		memo_fail(cpu, mark & MEMO_RET ? "return address modified" : "self-modifying code");
+		return;
+	}
+
+	if (mark & MEMO_WRITTEN) {
+		for (i = 0; e->writes[i].addr != addr; ++i)
+			;
+		e->writes[i].data = data;
+		return;
+	}
+
+	if (e->nwrites == MEMO_WRITES) {
+		memo_fail(cpu, "too many writes");
+		return;
+	}
+
+	e->writes[e->nwrites].addr = addr;
+	e->writes[e->nwrites].data = data;
+	e->nwrites++;
+	memo->marks[addr] |= MEMO_WRITTEN;
+}
+
+int simak65_memo_report(const struct simak65_memo *memo, FILE *f)
+{
+	const struct memo_routine *r;
+	unsigned int i;
+
+	fprintf(f, "; %-9s %12s %12s %6s %7s\n", "routine", "calls", "hits", "hit%", "entries");
+
+	for (i = 0; i < 0x10000; ++i) {
+		r = memo->routines[i];
+		if (r == NULL)
+			continue;
+
+		fprintf(f, "  sub_%04x  %12llu %12llu %5.1f%% ", i, (unsigned long long)r->calls,
+			(unsigned long long)r->hits, r->calls ? 100.0 * r->hits / r->calls : 0.0);
+
+		if (r->impure)
+			fprintf(f, "%7s\n", "impure");
+		else
+			fprintf(f, "%7u\n", r->count);
+	}
+
+	return ferror(f) ? -1 : 0;
+}
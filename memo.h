@@ -0,0 +1,33 @@
+/* SimAK65 subroutine memoization
+ * Copyright A.K. 2026
+ */
+
+#ifndef SIMAK65_MEMO_H_
+#define SIMAK65_MEMO_H_
+
+#include "types.h"
+#include "simak65.h"
+#include "decoder.h"
+
+/* Called after JSR, sp is the stack pointer before the return address
+ * was pushed and ret the address the subroutine returns to */
+void memo_call(struct simak65_cpu *cpu, u8 sp, u16 ret);
+
+/* Called after RTS while a call is recorded */
+void memo_return(struct simak65_cpu *cpu);
+
+/* Called before every instruction executed while a call is recorded */
+void memo_insn(struct simak65_cpu *cpu, enum opcode opcode, enum addrmode mode);
+
+/* The routine being recorded can't be cached */
+void memo_fail(struct simak65_cpu *cpu, const char *reason);
+
+/* Drop the call being recorded, on interrupts and state changes */
+void memo_abort(struct simak65_cpu *cpu);
+
+/* Bus accesses while a call is recorded */
+void memo_read(struct simak65_cpu *cpu, u16 addr, u8 data, int fetch);
+
+void memo_write(struct simak65_cpu *cpu, u16 addr, u8 data);
+
+#endif /* SIMAK65_MEMO_H_ */
@@ -0,0 +1,186 @@
+/* SimAK65 shared memory metrics
+ * Copyright A.K. 2026
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "error.h"
+#include "metrics.h"
+#include "simak65.h"
+
+#define METRICS_MAGIC "SK65MTR1"
+
+/* Shared block, fields are written only between the two increments of
+ * an odd seq (seqlock) */
+struct metrics_block {
+	char magic[8];
+	uint32_t seq;
+	uint32_t pid;
+	uint64_t time;
+	uint64_t cycles;
+	uint64_t instructions;
+	uint32_t stop;
+	uint32_t pc;
+};
+
+static struct simak65_metrics *metrics_map(const char *name, int create)
+{
+	struct simak65_metrics *m;
+	int fd;
+
+	m = malloc(sizeof(*m) + strlen(name) + 1);
+	if (m == NULL)
+		return NULL;
+
+	strcpy(m->name, name);
+	m->owner = create;
+	m->next = 0;
+	m->interval = 0;
+
+	if (create)
+		fd = shm_open(name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	else
+		fd = shm_open(name, O_RDONLY, 0);
+
+	if (fd < 0) {
+		WARN("Could not open shared memory %s", name);
+		free(m);
+		return NULL;
+	}
+
+	if (create && ftruncate(fd, sizeof(struct metrics_block)) < 0) {
+		WARN("Could not size shared memory %s", name);
+		close(fd);
+		shm_unlink(name);
+		free(m);
+		return NULL;
+	}
+
+	m->block = mmap(NULL, sizeof(struct metrics_block), create ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (m->block == MAP_FAILED) {
+		WARN("Could not map shared memory %s", name);
+		if (create)
+			shm_unlink(name);
+		free(m);
+		return NULL;
+	}
+
+	if (!create && memcmp(m->block->magic, METRICS_MAGIC, sizeof(m->block->magic)) != 0) {
+		WARN("%s is not a metrics block", name);
+		munmap(m->block, sizeof(struct metrics_block));
+		free(m);
+		return NULL;
+	}
+
+	return m;
+}
+
+struct simak65_metrics *simak65_metrics_create(const char *name, unsigned long interval)
+{
+	struct simak65_metrics *m;
+
+	if (interval == 0) {
+		WARN("Invalid metrics interval");
+		return NULL;
+	}
+
+	m = metrics_map(name, 1);
+	if (m == NULL)
+		return NULL;
+
+	m->interval = interval;
+	m->block->pid = getpid();
+	m->block->stop = simak65_stop_none;
+	memcpy(m->block->magic, METRICS_MAGIC, sizeof(m->block->magic));
+
+	return m;
+}
+
+struct simak65_metrics *simak65_metrics_open(const char *name)
+{
+	return metrics_map(name, 0);
+}
+
+void simak65_metrics_destroy(struct simak65_metrics *m)
+{
+	if (m == NULL)
+		return;
+
+	munmap(m->block, sizeof(struct metrics_block));
+
+	if (m->owner)
+		shm_unlink(m->name);
+
+	free(m);
+}
+
+void simak65_metrics_attach(struct simak65_cpu *cpu, struct simak65_metrics *m)
+{
+	if (m != NULL && !m->owner) {
+		WARN("Metrics opened for reading");
+		return;
+	}
+
+	cpu->metrics = m;
+
+	if (m != NULL)
+		metrics_publish(cpu, cpu->stop);
+}
+
+void metrics_publish(struct simak65_cpu *cpu, enum simak65_stop stop)
+{
+	struct simak65_metrics *m = cpu->metrics;
+	struct metrics_block *b = m->block;
+	struct timespec ts;
+	uint32_t seq;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	seq = __atomic_load_n(&b->seq, __ATOMIC_RELAXED);
+	__atomic_store_n(&b->seq, seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	__atomic_store_n(&b->time, (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec, __ATOMIC_RELAXED);
+	__atomic_store_n(&b->cycles, cpu->cycles, __ATOMIC_RELAXED);
+	__atomic_store_n(&b->instructions, cpu->perf.instructions, __ATOMIC_RELAXED);
+	__atomic_store_n(&b->stop, stop, __ATOMIC_RELAXED);
+	__atomic_store_n(&b->pc, cpu->reg.pc, __ATOMIC_RELAXED);
+
+	__atomic_store_n(&b->seq, seq + 2, __ATOMIC_RELEASE);
+
+	m->next = cpu->cycles + m->interval;
+}
+
+int simak65_metrics_read(const struct simak65_metrics *m, struct simak65_metrics_sample *sample)
+{
+	const struct metrics_block *b = m->block;
+	unsigned int tries;
+	uint32_t seq;
+
+	for (tries = 0; tries < 1000; ++tries) {
+		seq = __atomic_load_n(&b->seq, __ATOMIC_ACQUIRE);
+		if (seq & 1)
+			continue;
+
+		sample->pid = __atomic_load_n(&b->pid, __ATOMIC_RELAXED);
+		sample->time = __atomic_load_n(&b->time, __ATOMIC_RELAXED);
+		sample->cycles = __atomic_load_n(&b->cycles, __ATOMIC_RELAXED);
+		sample->instructions = __atomic_load_n(&b->instructions, __ATOMIC_RELAXED);
+		sample->stop = __atomic_load_n(&b->stop, __ATOMIC_RELAXED);
+		sample->pc = __atomic_load_n(&b->pc, __ATOMIC_RELAXED);
+
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+		if (__atomic_load_n(&b->seq, __ATOMIC_RELAXED) == seq)
+			return 0;
+	}
+
+	return -1;
+}
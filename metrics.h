@@ -0,0 +1,26 @@
+/* SimAK65 shared memory metrics
+ * Copyright A.K. 2026
+ */
+
+#ifndef SIMAK65_METRICS_H_
+#define SIMAK65_METRICS_H_
+
+#include "types.h"
+#include "simak65.h"
+
+struct metrics_block;
+
+struct simak65_metrics {
+	struct metrics_block *block;
+	/* Cycle of the next update */
+	unsigned long next;
+	unsigned long interval;
+	/* Created by this process, unlinked on destroy */
+	int owner;
+	char name[];
+};
+
+/* Update the shared block, sets the next update cycle */
+void metrics_publish(struct simak65_cpu *cpu, enum simak65_stop stop);
+
+#endif /* SIMAK65_METRICS_H_ */
@@ -0,0 +1,17 @@
+/* SimAK65 performance counters
+ * Copyright A.K. 2026
+ */
+
+#include <string.h>
+#include "perf.h"
+#include "simak65.h"
+
+void simak65_perf_read(const struct simak65_cpu *cpu, struct simak65_perf *perf)
+{
+	*perf = cpu->perf;
+}
+
+void simak65_perf_reset(struct simak65_cpu *cpu)
+{
+	memset(&cpu->perf, 0, sizeof(cpu->perf));
+}
@@ -0,0 +1,17 @@
+/* SimAK65 performance counters
+ * Copyright A.K. 2026
+ */
+
+#ifndef SIMAK65_PERF_H_
+#define SIMAK65_PERF_H_
+
+#include "simak65.h"
+
+/* Build with -DSIMAK65_NO_PERF to drop counting, the fields stay */
+#ifndef SIMAK65_NO_PERF
+#define PERF_INC(cpu, counter) ((cpu)->perf.counter++)
+#else
+#define PERF_INC(cpu, counter) do { } while (0)
+#endif
+
+#endif /* SIMAK65_PERF_H_ */
@@ -0,0 +1,106 @@
+/* SimAK65 per-address profiler
+ * Copyright A.K. 2026
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "error.h"
+#include "decoder.h"
+#include "hook.h"
+#include "bus.h"
+#include "simak65.h"
+
+struct simak65_profile *simak65_profile_create(void)
+{
+	return calloc(1, sizeof(struct simak65_profile));
+}
+
+void simak65_profile_destroy(struct simak65_profile *prof)
+{
+	free(prof);
+}
+
+void simak65_profile_attach(struct simak65_cpu *cpu, struct simak65_profile *prof)
+{
+	if (prof != NULL) {
+		cpu->profile = prof;
+		hook_set(cpu, HOOK_PROFILE, 1);
+	}
+	else {
+		hook_set(cpu, HOOK_PROFILE, 0);
+		cpu->profile = NULL;
+	}
+}
+
+void simak65_profile_reset(struct simak65_profile *prof)
+{
+	memset(prof, 0, sizeof(*prof));
+}
+
+static int profile_put(FILE *f, uint64_t v)
+{
+	u8 buf[8];
+	unsigned int i;
+
+	for (i = 0; i < sizeof(buf); ++i) {
+		buf[i] = v & 0xff;
+		v >>= 8;
+	}
+
+	return (fwrite(buf, 1, sizeof(buf), f) == sizeof(buf)) ? 0 : -1;
+}
+
+int simak65_profile_write(const struct simak65_profile *prof, FILE *f)
+{
+	unsigned int addr;
+
+	/* Instruction counts then cycles, 64-bit little endian per address */
+	for (addr = 0; addr < 0x10000; ++addr) {
+		if (profile_put(f, prof->insns[addr]) < 0)
+			return -1;
+	}
+
+	for (addr = 0; addr < 0x10000; ++addr) {
+		if (profile_put(f, prof->cycles[addr]) < 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+int simak65_profile_report(const struct simak65_profile *prof, struct simak65_cpu *cpu, FILE *f)
+{
+	uint64_t insns = 0, cycles = 0;
+	unsigned int addr, i;
+	char text[32];
+	u8 bytes[3];
+
+	for (addr = 0; addr < 0x10000; ++addr) {
+		insns += prof->insns[addr];
+		cycles += prof->cycles[addr];
+	}
+
+	fprintf(f, "; %llu instructions, %llu cycles\n", (unsigned long long)insns, (unsigned long long)cycles);
+	fprintf(f, "; addr %14s %14s %7s  instruction\n", "count", "cycles", "cycles%");
+
+	for (addr = 0; addr < 0x10000; ++addr) {
+		if (prof->insns[addr] == 0)
+			continue;
+
+		/* Code is read back without touching I/O pages */
+		for (i = 0; i < sizeof(bytes); ++i) {
+			u16 at = addr + i;
+			bytes[i] = (cpu != NULL && !bus_isio(cpu, at)) ? cpu->bus.read(at) : 0;
+		}
+
+		if (cpu != NULL && !bus_isio(cpu, addr))
+			decode_disasm(text, sizeof(text), addr, bytes);
+		else
+			text[0] = '\0';
+
+		fprintf(f, "  %04x %14llu %14llu %6.2f%%  %s\n", addr, (unsigned long long)prof->insns[addr],
+			(unsigned long long)prof->cycles[addr], cycles ? 100.0 * prof->cycles[addr] / cycles : 0.0, text);
+	}
+
+	return ferror(f) ? -1 : 0;
+}
@@ -0,0 +1,54 @@
+/* SimAK65 published registers
+ * Copyright A.K. 2026
+ */
+
+#include "simak65.h"
+
+void simak65_regs_interval(struct simak65_cpu *cpu, unsigned long interval)
+{
+	cpu->pub.interval = interval;
+	cpu->pub.next = cpu->cycles + interval;
+}
+
+void simak65_regs_publish(struct simak65_cpu *cpu)
+{
+	struct simak65_regs *r = &cpu->pub.regs;
+	uint32_t seq = cpu->pub.seq;
+
+	/* Odd seq marks an update in progress */
+	__atomic_store_n(&cpu->pub.seq, seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	__atomic_store_n(&r->pc, cpu->reg.pc, __ATOMIC_RELAXED);
+	__atomic_store_n(&r->a, cpu->reg.a, __ATOMIC_RELAXED);
+	__atomic_store_n(&r->x, cpu->reg.x, __ATOMIC_RELAXED);
+	__atomic_store_n(&r->y, cpu->reg.y, __ATOMIC_RELAXED);
+	__atomic_store_n(&r->sp, cpu->reg.sp, __ATOMIC_RELAXED);
+	__atomic_store_n(&r->flags, cpu->reg.flags, __ATOMIC_RELAXED);
+	__atomic_store_n(&r->cycles, cpu->cycles, __ATOMIC_RELAXED);
+
+	__atomic_store_n(&cpu->pub.seq, seq + 2, __ATOMIC_RELEASE);
+
+	cpu->pub.next = cpu->cycles + cpu->pub.interval;
+}
+
+void simak65_regs_read(const struct simak65_cpu *cpu, struct simak65_regs *regs)
+{
+	const struct simak65_regs *r = &cpu->pub.regs;
+	uint32_t seq;
+
+	do {
+		while ((seq = __atomic_load_n(&cpu->pub.seq, __ATOMIC_ACQUIRE)) & 1)
+			;
+
+		regs->pc = __atomic_load_n(&r->pc, __ATOMIC_RELAXED);
+		regs->a = __atomic_load_n(&r->a, __ATOMIC_RELAXED);
+		regs->x = __atomic_load_n(&r->x, __ATOMIC_RELAXED);
+		regs->y = __atomic_load_n(&r->y, __ATOMIC_RELAXED);
+		regs->sp = __atomic_load_n(&r->sp, __ATOMIC_RELAXED);
+		regs->flags = __atomic_load_n(&r->flags, __ATOMIC_RELAXED);
+		regs->cycles = __atomic_load_n(&r->cycles, __ATOMIC_RELAXED);
+
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	} while (__atomic_load_n(&cpu->pub.seq, __ATOMIC_RELAXED) != seq);
+}
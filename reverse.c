@@ -0,0 +1,266 @@
+/* SimAK65 reverse execution
+ * Copyright A.K. 2026
+ *
+ * A ring of periodic checkpoints is kept along with the input log. Going
+ * back restores the nearest checkpoint and replays forward to the target
+ * instruction. Execution keeps replaying from the log until it catches up
+ * with the furthest point reached, then recording continues from there.
+ */
+
+#include <stdlib.h>
+#include "error.h"
+#include "reverse.h"
+#include "snapshot.h"
+#include "log.h"
+#include "hook.h"
+#include "simak65.h"
+
+struct checkpoint {
+	struct simak65_snapshot *snap;
+	unsigned long step;
+};
+
+struct simak65_reverse {
+	unsigned long interval;
+	unsigned int count;
+
+	/* Ring of checkpoints, oldest first */
+	struct checkpoint *ring;
+	unsigned int first;
+	unsigned int used;
+
+	/* Instructions executed, current and the furthest recorded */
+	unsigned long step;
+	unsigned long head;
+};
+
+static struct checkpoint *reverse_checkpoint(struct simak65_reverse *rev, unsigned int i)
+{
+	return &rev->ring[(rev->first + i) % rev->count];
+}
+
+static int reverse_take(struct simak65_cpu *cpu)
+{
+	struct simak65_reverse *rev = cpu->rev;
+	struct simak65_snapshot *snap;
+	struct checkpoint *cp;
+
+	/* A lone checkpoint is replaced, a delta would keep the old one alive
+	 * with nothing left to fold it into */
+	if (rev->count == 1 && rev->used == 1)
+		simak65_snapshot_reset(cpu);
+
+	snap = simak65_snapshot_take(cpu);
+	if (snap == NULL)
+		return -1;
+
+	if (rev->used == rev->count) {
+		/* Drop the oldest, the next one becomes the chain base */
+		cp = reverse_checkpoint(rev, 0);
+		simak65_snapshot_free(cp->snap);
+		rev->first = (rev->first + 1) % rev->count;
+		--rev->used;
+
+		if (rev->used != 0 && snapshot_fold(reverse_checkpoint(rev, 0)->snap) < 0)
+			WARN("Failed to fold the checkpoint chain");
+	}
+
+	cp = reverse_checkpoint(rev, rev->used++);
+	cp->snap = snap;
+	cp->step = rev->step;
+
+	DEBUG("Checkpoint at step %lu, cycle %lu", rev->step, cpu->cycles);
+
+	return 0;
+}
+
+void reverse_step(struct simak65_cpu *cpu)
+{
+	struct simak65_reverse *rev = cpu->rev;
+	const struct checkpoint *last;
+
+	++rev->step;
+
+	if (cpu->log == NULL)
+		return;
+
+	if (cpu->log->mode == log_replay) {
+		if (rev->step < rev->head)
+			return;
+
+		/* Caught up with the recording, go live */
+		if (log_resume(cpu->log) < 0)
+			WARN("Failed to resume recording");
+	}
+
+	rev->head = rev->step;
+
+	last = reverse_checkpoint(rev, rev->used - 1);
+	if (cpu->cycles - last->snap->cycles >= rev->interval)
+		reverse_take(cpu);
+}
+
+static int reverse_goto(struct simak65_cpu *cpu, unsigned int i, unsigned long step)
+{
+	struct simak65_reverse *rev = cpu->rev;
+	const struct checkpoint *cp = reverse_checkpoint(rev, i);
+
+	if (log_seek(cpu->log, cp->snap->logpos) < 0) {
+		WARN("Failed to seek the input log");
+		return -1;
+	}
+
+	simak65_snapshot_restore(cpu, cp->snap);
+	rev->step = cp->step;
+
+	/* Deltas taken from here would chain onto this checkpoint and keep it
+	 * alive once dropped from the ring, make the next one full */
+	simak65_snapshot_reset(cpu);
+	log_step(cpu);
+
+	while (rev->step < step)
+		simak65_step(cpu);
+
+	return 0;
+}
+
+static int reverse_find(const struct simak65_reverse *rev, unsigned long step)
+{
+	int i;
+
+	for (i = rev->used - 1; i >= 0; --i) {
+		if (rev->ring[(rev->first + i) % rev->count].step <= step)
+			return i;
+	}
+
+	return -1;
+}
+
+int simak65_reverse_step(struct simak65_cpu *cpu)
+{
+	struct simak65_reverse *rev = cpu->rev;
+	int i;
+
+	if (rev == NULL || rev->step == 0)
+		return -1;
+
+	i = reverse_find(rev, rev->step - 1);
+	if (i < 0)
+		return -1;
+
+	return reverse_goto(cpu, i, rev->step - 1);
+}
+
+int simak65_reverse_continue(struct simak65_cpu *cpu, int (*stop)(struct simak65_cpu *cpu))
+{
+	struct simak65_reverse *rev = cpu->rev;
+	unsigned long end, found;
+	int i, hit;
+
+	if (rev == NULL || rev->step == 0)
+		return -1;
+
+	if (stop == NULL)
+		stop = simak65_break_hit;
+
+	end = rev->step;
+
+	for (i = reverse_find(rev, end - 1); i >= 0; --i) {
+		if (reverse_goto(cpu, i, reverse_checkpoint(rev, i)->step) < 0)
+			return -1;
+
+		/* Find the last stop in this segment, before the starting point */
+		hit = 0;
+		found = 0;
+		while (1) {
+			if (stop(cpu)) {
+				hit = 1;
+				found = rev->step;
+			}
+
+			if (rev->step + 1 >= end)
+				break;
+
+			simak65_step(cpu);
+		}
+
+		if (hit)
+			return reverse_goto(cpu, i, found);
+
+		end = reverse_checkpoint(rev, i)->step;
+		if (end == 0)
+			break;
+	}
+
+	/* History exhausted, stay at the oldest checkpoint */
+	if (rev->used != 0)
+		reverse_goto(cpu, 0, reverse_checkpoint(rev, 0)->step);
+
+	return -1;
+}
+
+int simak65_reverse_start(struct simak65_cpu *cpu, FILE *f, unsigned long interval, unsigned int count)
+{
+	struct simak65_reverse *rev;
+
+	if (count == 0)
+		return -1;
+
+	if (cpu->rev != NULL)
+		simak65_reverse_stop(cpu);
+
+	rev = malloc(sizeof(*rev));
+	if (rev == NULL)
+		return -1;
+
+	rev->ring = malloc(count * sizeof(*rev->ring));
+	if (rev->ring == NULL) {
+		free(rev);
+		return -1;
+	}
+
+	rev->interval = interval;
+	rev->count = count;
+	rev->first = 0;
+	rev->used = 0;
+	rev->step = 0;
+	rev->head = 0;
+
+	if (simak65_record(cpu, f) < 0) {
+		free(rev->ring);
+		free(rev);
+		return -1;
+	}
+
+	cpu->rev = rev;
+	hook_set(cpu, HOOK_REVERSE, 1);
+
+	/* Start from a full checkpoint */
+	simak65_snapshot_reset(cpu);
+	if (reverse_take(cpu) < 0) {
+		simak65_reverse_stop(cpu);
+		return -1;
+	}
+
+	return 0;
+}
+
+void simak65_reverse_stop(struct simak65_cpu *cpu)
+{
+	struct simak65_reverse *rev = cpu->rev;
+	unsigned int i;
+
+	if (rev == NULL)
+		return;
+
+	for (i = 0; i < rev->used; ++i)
+		simak65_snapshot_free(reverse_checkpoint(rev, i)->snap);
+
+	free(rev->ring);
+	free(rev);
+	hook_set(cpu, HOOK_REVERSE, 0);
+	cpu->rev = NULL;
+
+	simak65_log_stop(cpu);
+	simak65_snapshot_reset(cpu);
+}
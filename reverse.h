@@ -0,0 +1,13 @@
+/* SimAK65 reverse execution
+ * Copyright A.K. 2026
+ */
+
+#ifndef SIMAK65_REVERSE_H_
+#define SIMAK65_REVERSE_H_
+
+#include "simak65.h"
+
+/* Called after every executed instruction */
+void reverse_step(struct simak65_cpu *cpu);
+
+#endif /* SIMAK65_REVERSE_H_ */
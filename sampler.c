@@ -0,0 +1,122 @@
+/* SimAK65 sampling profiler
+ * Copyright A.K. 2026
+ */
+
+#include <stdlib.h>
+#include "error.h"
+#include "sampler.h"
+#include "hook.h"
+#include "simak65.h"
+
+/* Distance to the next sample, uniform in [1, 2 * interval) so it does
+ * not alias with periodic guest loops */
+static unsigned long sampler_delay(struct simak65_sampler *s)
+{
+	/* xorshift32 */
+	s->rng ^= s->rng << 13;
+	s->rng ^= s->rng >> 17;
+	s->rng ^= s->rng << 5;
+
+	if (s->interval < 2)
+		return 1;
+
+	return 1 + s->rng % (2 * s->interval - 1);
+}
+
+struct simak65_sampler *simak65_sampler_create(unsigned int count, unsigned long interval)
+{
+	struct simak65_sampler *s;
+
+	if (count == 0 || interval == 0) {
+		WARN("Invalid sampler size %u or interval %lu", count, interval);
+		return NULL;
+	}
+
+	s = malloc(sizeof(*s) + count * sizeof(s->pcs[0]));
+	if (s == NULL)
+		return NULL;
+
+	s->interval = interval;
+	s->rng = 0x9e3779b9;
+	s->next = 0;
+	s->head = 0;
+	s->tail = 0;
+	s->size = count;
+
+	return s;
+}
+
+void simak65_sampler_destroy(struct simak65_sampler *s)
+{
+	free(s);
+}
+
+void simak65_sampler_attach(struct simak65_cpu *cpu, struct simak65_sampler *s)
+{
+	if (s != NULL) {
+		s->next = cpu->cycles + sampler_delay(s);
+		cpu->sampler = s;
+		hook_set(cpu, HOOK_SAMPLER, 1);
+	}
+	else {
+		hook_set(cpu, HOOK_SAMPLER, 0);
+		cpu->sampler = NULL;
+	}
+}
+
+void sampler_check(struct simak65_cpu *cpu, u16 pc, unsigned long cycles)
+{
+	struct simak65_sampler *s = cpu->sampler;
+
+	if (cycles <= s->next)
+		return;
+
+	__atomic_store_n(&s->pcs[s->head % s->size], pc, __ATOMIC_RELAXED);
+	__atomic_store_n(&s->head, s->head + 1, __ATOMIC_RELEASE);
+
+	/* The slot overwritten next must not change before head is visible,
+	 * the reader checks head again after copying */
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	s->next += sampler_delay(s);
+	if (s->next < cycles)
+		s->next = cycles + sampler_delay(s);
+
+	hook_update(cpu);
+}
+
+unsigned int simak65_sampler_read(struct simak65_sampler *s, uint16_t *pcs, unsigned int count)
+{
+	uint64_t head, tail = s->tail, lost;
+	unsigned int n, i;
+
+	head = __atomic_load_n(&s->head, __ATOMIC_ACQUIRE);
+
+	/* Samples overwritten before being read are lost */
+	if (head - tail > s->size)
+		tail = head - s->size;
+
+	n = (head - tail < count) ? head - tail : count;
+	for (i = 0; i < n; ++i)
+		pcs[i] = __atomic_load_n(&s->pcs[(tail + i) % s->size], __ATOMIC_RELAXED);
+
+	/* So are the ones the writer got to in the meantime */
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	head = __atomic_load_n(&s->head, __ATOMIC_RELAXED);
+
+	if (head - tail > s->size) {
+		lost = head - s->size - tail;
+		if (lost > n)
+			lost = n;
+
+		for (i = lost; i < n; ++i)
+			pcs[i - lost] = pcs[i];
+
+		tail += lost;
+		n -= lost;
+	}
+
+	s->tail = tail + n;
+
+	return n;
+}
@@ -0,0 +1,34 @@
+/* SimAK65 sampling profiler
+ * Copyright A.K. 2026
+ */
+
+#ifndef SIMAK65_SAMPLER_H_
+#define SIMAK65_SAMPLER_H_
+
+#include "types.h"
+#include "simak65.h"
+
+/* Cycles before the next sample the core starts checking, covers the
+ * longest instruction so the sample lands on the one executing */
+#define SAMPLER_LEAD 8
+
+struct simak65_sampler {
+	/* Cycle of the next sample */
+	unsigned long next;
+	unsigned long interval;
+	u32 rng;
+
+	/* Samples taken and read so far, the buffer keeps the newest ones.
+	 * head is published with release semantics, tail belongs to the
+	 * reader */
+	uint64_t head;
+	uint64_t tail;
+	unsigned int size;
+	uint16_t pcs[];
+};
+
+/* Record pc if the countdown expired while it executed, cycles is the
+ * count after the instruction */
+void sampler_check(struct simak65_cpu *cpu, u16 pc, unsigned long cycles);
+
+#endif /* SIMAK65_SAMPLER_H_ */
@@ -3,21 +3,282 @@
  */
 
 #include <stddef.h>
+#include <limits.h>
+#include <string.h>
+#include "error.h"
 #include "simak65.h"
 #include "decoder.h"
 #include "addrmode.h"
 #include "types.h"
 #include "exec.h"
+#include "log.h"
+#include "reverse.h"
+#include "trace.h"
+#include "tracefile.h"
+#include "breakpoint.h"
+#include "hook.h"
+#include "sampler.h"
+#include "perf.h"
+#include "metrics.h"
+#include "trap.h"
+#include "memo.h"
+#include "aot.h"
 
-void simak65_step(struct simak65_cpu *cpu)
+/* Upper bound of the cycles a fused sequence takes */
+#define FUSE_CYCLES 32
+
+static inline void step_count(struct simak65_cpu *cpu, u8 opcode, enum opcode instruction)
+{
+	(void)cpu;
+	(void)opcode;
+	(void)instruction;
+
+	PERF_INC(cpu, instructions);
+
+	/* Undocumented opcodes decode as NOP */
+	if (instruction == NOP && opcode != 0xea)
+		PERF_INC(cpu, invalid);
+}
+
+/* Fetch and execute with the trace hooks */
+static void step_traced(struct simak65_cpu *cpu, u16 pc, unsigned long cycles)
+{
+	u8 args[2], bytes[3] = { 0, 0, 0 };
+	const u8 *operand = bytes + 1;
+	struct opinfo instruction;
+	enum argtype argtype;
+	struct simak65_trace *trace;
+	struct simak65_trace_rec rec;
+	u8 opcode;
+
+	/* Instruction bytes are kept for the record as they are fetched, not
+	 * read again */
+	cpu->fetched = bytes;
+	opcode = addrmode_nextpc(cpu);
+	instruction = decode(opcode);
+	argtype = addrmode_getArgs(cpu, args, instruction.mode);
+	cpu->fetched = NULL;
+	step_count(cpu, opcode, instruction.opcode);
+
+	if (cpu->memo_rec != NULL)
+		memo_insn(cpu, instruction.opcode, instruction.mode);
+
+	trace = __atomic_load_n(&cpu->trace, __ATOMIC_RELAXED);
+	if (trace != NULL)
+		trace_record(trace, cpu, pc, cycles, opcode, operand, argtype, args);
+
+	if (cpu->tracefile != NULL) {
+		trace_fill(&rec, cpu, pc, cycles, opcode, operand, argtype, args);
+		tracefile_record(cpu->tracefile, &rec);
+	}
+
+	exec_execute(cpu, instruction.opcode, argtype, args);
+}
+
+/* Step with any of the optional per-instruction features enabled */
+static void step_hooked(struct simak65_cpu *cpu)
+{
+	struct simak65_profile *prof = cpu->profile;
+	unsigned long cycles = cpu->cycles;
+	u16 pc = cpu->reg.pc;
+
+	/* A trapped routine runs natively as a single step */
+	if (cpu->traps == NULL || trap_run(cpu) < 0)
+		step_traced(cpu, pc, cycles);
+
+	if (prof != NULL) {
+		prof->insns[pc]++;
+		prof->cycles[pc] += cpu->cycles - cycles;
+	}
+
+	if (cpu->sampler != NULL)
+		sampler_check(cpu, pc, cpu->cycles);
+
+	if (cpu->log != NULL)
+		log_step(cpu);
+
+	if (cpu->rev != NULL)
+		reverse_step(cpu);
+}
+
+/* Execute the instruction whose opcode was just fetched */
+static inline void step_opcode(struct simak65_cpu *cpu, u8 opcode)
 {
 	u8 args[2];
+	struct opinfo instruction;
+	enum argtype argtype;
 
-	struct opinfo instruction = decode(addrmode_nextpc(cpu));
-	enum argtype argtype = addrmode_getArgs(cpu, args, instruction.mode);
+	instruction = decode(opcode);
+	argtype = addrmode_getArgs(cpu, args, instruction.mode);
+	step_count(cpu, opcode, instruction.opcode);
 	exec_execute(cpu, instruction.opcode, argtype, args);
 }
 
+void simak65_step(struct simak65_cpu *cpu)
+{
+	if (cpu->cycles >= __atomic_load_n(&cpu->hook_at, __ATOMIC_RELAXED)) {
+		step_hooked(cpu);
+		return;
+	}
+
+	/* A trapped routine runs natively as a single step */
+	if (cpu->traps != NULL && trap_run(cpu) == 0)
+		return;
+
+	step_opcode(cpu, addrmode_nextpc(cpu));
+}
+
+/* Step through a whole fused sequence if one starts here, only while
+ * neither a hook nor the end can become due within it */
+static inline void step_fused(struct simak65_cpu *cpu, unsigned long end)
+{
+	unsigned long at = __atomic_load_n(&cpu->hook_at, __ATOMIC_RELAXED);
+	exec_fuse_t fuse;
+	int opcode;
+
+	if (cpu->cycles + FUSE_CYCLES >= ((at < end) ? at : end)) {
+		simak65_step(cpu);
+		return;
+	}
+
+	opcode = addrmode_nextpc(cpu);
+
+	fuse = exec_fuse[opcode];
+	if (fuse != NULL && (opcode = fuse(cpu)) < 0)
+		return;
+
+	step_opcode(cpu, opcode);
+}
+
+/* Run the recompiled block starting here, falling back to the interpreter
+ * where there is none */
+static inline void step_aot(struct simak65_cpu *cpu, const struct simak65_aot *aot, unsigned long end)
+{
+	unsigned long at = __atomic_load_n(&cpu->hook_at, __ATOMIC_RELAXED);
+	u16 offs = cpu->reg.pc - aot->base;
+
+	if (offs < aot->size && aot->blocks[offs] != NULL && cpu->cycles + AOT_CYCLES < ((at < end) ? at : end)) {
+		aot->blocks[offs](cpu);
+		return;
+	}
+
+	step_fused(cpu, end);
+}
+
+/* Run until end, skip tells whether a breakpoint at the starting point is
+ * ignored. Callbacks may clear breakpoints during the run, freeing the
+ * bitmap, so it is looked up again before every instruction. Fused
+ * sequences and recompiled blocks can run into a trapped routine, so they
+ * are left once a trap is set. */
+static enum simak65_stop run_loop(struct simak65_cpu *cpu, unsigned long end, int skip)
+{
+	unsigned long start = cpu->cycles;
+	const u8 *bp;
+	u16 pc;
+
+	cpu->stop = simak65_stop_none;
+	cpu->idiom.end = end;
+
+	if (cpu->breakpoints == NULL && cpu->watch_read == NULL && cpu->watch_write == NULL) {
+		if (cpu->aot != NULL) {
+			while (cpu->cycles < end && cpu->traps == NULL)
+				step_aot(cpu, cpu->aot, end);
+		}
+		else {
+			while (cpu->cycles < end && cpu->traps == NULL)
+				step_fused(cpu, end);
+		}
+
+		if (cpu->cycles != start)
+			skip = 0;
+	}
+
+	if (cpu->cycles < end) {
+		pc = cpu->reg.pc;
+		bp = cpu->breakpoints;
+
+		if (!skip && bp != NULL && breakpoint_test(bp, pc)) {
+			DEBUG("Breakpoint hit at 0x%04x", pc);
+			cpu->stop = simak65_stop_break;
+			return cpu->stop;
+		}
+
+		simak65_step(cpu);
+
+		while (cpu->stop == simak65_stop_none && cpu->cycles < end) {
+			pc = cpu->reg.pc;
+			bp = cpu->breakpoints;
+
+			if (bp != NULL && breakpoint_test(bp, pc)) {
+				DEBUG("Breakpoint hit at 0x%04x", pc);
+				cpu->stop = simak65_stop_break;
+				return cpu->stop;
+			}
+
+			simak65_step(cpu);
+		}
+
+		if (cpu->stop == simak65_stop_watch) {
+			cpu->watch.pc = pc;
+			return cpu->stop;
+		}
+	}
+
+	cpu->stop = simak65_stop_cycles;
+
+	return cpu->stop;
+}
+
+/* Publish what is due, or everything if stopping */
+static void run_publish(struct simak65_cpu *cpu, enum simak65_stop stop)
+{
+	int force = (stop != simak65_stop_none);
+
+	if (cpu->metrics != NULL && (force || cpu->cycles >= cpu->metrics->next))
+		metrics_publish(cpu, stop);
+
+	if (cpu->pub.interval != 0 && (force || cpu->cycles >= cpu->pub.next))
+		simak65_regs_publish(cpu);
+}
+
+/* End of the slice to run before publishing again */
+static unsigned long run_slice(const struct simak65_cpu *cpu, unsigned long end)
+{
+	if (cpu->metrics != NULL && cpu->metrics->next < end)
+		end = cpu->metrics->next;
+
+	if (cpu->pub.interval != 0 && cpu->pub.next < end)
+		end = cpu->pub.next;
+
+	return end;
+}
+
+enum simak65_stop simak65_run(struct simak65_cpu *cpu, unsigned long cycles)
+{
+	unsigned long end = cpu->cycles + cycles;
+	enum simak65_stop stop;
+	int skip = 1;
+
+	if (cpu->metrics == NULL && cpu->pub.interval == 0) {
+		stop = run_loop(cpu, end, 1);
+		cpu->idiom.end = ULONG_MAX;
+		return stop;
+	}
+
+	/* Run in slices, publishing metrics and registers in between */
+	do {
+		run_publish(cpu, simak65_stop_none);
+
+		stop = run_loop(cpu, run_slice(cpu, end), skip);
+		skip = 0;
+	} while (stop == simak65_stop_cycles && cpu->cycles < end);
+
+	cpu->idiom.end = ULONG_MAX;
+	run_publish(cpu, stop);
+
+	return stop;
+}
+
 void simak65_rst(struct simak65_cpu *cpu)
 {
 	exec_rst(cpu);
@@ -25,11 +286,17 @@ void simak65_rst(struct simak65_cpu *cpu)
 
 void simak65_nmi(struct simak65_cpu *cpu)
 {
+	if (cpu->log != NULL && log_interrupt(cpu, log_nmi) < 0)
+		return;
+
 	exec_nmi(cpu);
 }
 
 void simak65_irq(struct simak65_cpu *cpu)
 {
+	if (cpu->log != NULL && log_interrupt(cpu, log_irq) < 0)
+		return;
+
 	exec_irq(cpu);
 }
 
@@ -42,4 +309,33 @@ void simak65_init(struct simak65_cpu *cpu)
 	cpu->reg.sp = 0;
 	cpu->reg.flags = 0;
 	cpu->cycles = 0;
+	memset(cpu->dirty, 0, sizeof(cpu->dirty));
+	cpu->snap = NULL;
+	memset(cpu->io, 0, sizeof(cpu->io));
+	cpu->log = NULL;
+	cpu->rev = NULL;
+	cpu->trace = NULL;
+	cpu->tracefile = NULL;
+	cpu->profile = NULL;
+	cpu->callgraph = NULL;
+	cpu->sampler = NULL;
+	cpu->heatmap = NULL;
+	memset(&cpu->perf, 0, sizeof(cpu->perf));
+	cpu->metrics = NULL;
+	memset(&cpu->pub, 0, sizeof(cpu->pub));
+	cpu->traps = NULL;
+	cpu->aot = NULL;
+	cpu->memo = NULL;
+	cpu->memo_rec = NULL;
+	cpu->fetched = NULL;
+	cpu->ram = NULL;
+	cpu->idiom.armed = 0;
+	cpu->idiom.end = ULONG_MAX;
+	cpu->hooks = 0;
+	cpu->hook_at = ULONG_MAX;
+	cpu->breakpoints = NULL;
+	cpu->nbreakpoints = 0;
+	cpu->watch_read = NULL;
+	cpu->watch_write = NULL;
+	cpu->stop = simak65_stop_none;
 }
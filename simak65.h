@@ -6,6 +6,136 @@
 #define SIMAK65_H_
 
 #include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct simak65_snapshot;
+struct simak65_log;
+struct simak65_reverse;
+struct simak65_trace;
+struct simak65_tracefile;
+struct simak65_tracemap;
+struct simak65_callgraph;
+struct simak65_sampler;
+struct simak65_metrics;
+struct simak65_traps;
+struct simak65_memo;
+struct simak65_cpu;
+
+/* Native routine, returns the cycles it takes or -1 to run the guest code */
+typedef int (*simak65_trap_fn)(struct simak65_cpu *cpu, void *arg);
+
+/* Basic block recompiled ahead of time by simak65-recomp */
+typedef void (*simak65_block_fn)(struct simak65_cpu *cpu);
+
+/* ROM image recompiled by simak65-recomp */
+struct simak65_aot {
+	uint16_t base;
+	uint32_t size;
+	const uint8_t *image;
+	/* Block starting at every offset in the image, NULL if none */
+	const simak65_block_fn *blocks;
+};
+
+enum simak65_stop {
+	simak65_stop_none,
+	simak65_stop_cycles,
+	simak65_stop_break,
+	simak65_stop_watch
+};
+
+#define SIMAK65_WATCH_READ  0x01
+#define SIMAK65_WATCH_WRITE 0x02
+
+/* Instruction trace record, registers before execution */
+struct simak65_trace_rec {
+	uint64_t cycles;
+	uint16_t pc;
+	/* Effective address, 0 if none */
+	uint16_t ea;
+	uint8_t opcode;
+	uint8_t operand[2];
+	uint8_t a;
+	uint8_t x;
+	uint8_t y;
+	uint8_t sp;
+	uint8_t flags;
+};
+
+/* Performance counters */
+struct simak65_perf {
+	uint64_t instructions;
+	/* Bus accesses */
+	uint64_t fetches;
+	uint64_t reads;
+	uint64_t writes;
+	uint64_t stack_reads;
+	uint64_t stack_writes;
+	uint64_t branches_taken;
+	uint64_t branches_not_taken;
+	/* IRQ and NMI */
+	uint64_t interrupts;
+	uint64_t invalid;
+	/* ADC and SBC in decimal mode */
+	uint64_t decimal;
+};
+
+/* Register copy published for other threads */
+struct simak65_regs {
+	uint16_t pc;
+	uint8_t a;
+	uint8_t x;
+	uint8_t y;
+	uint8_t sp;
+	uint8_t flags;
+	unsigned long cycles;
+};
+
+/* Live metrics of a running instance */
+struct simak65_metrics_sample {
+	uint32_t pid;
+	/* CLOCK_MONOTONIC of the update in ns */
+	uint64_t time;
+	uint64_t cycles;
+	/* Zero if built with SIMAK65_NO_PERF */
+	uint64_t instructions;
+	/* simak65_stop_none while running */
+	enum simak65_stop stop;
+	uint16_t pc;
+};
+
+/* Memory access kinds counted by the heatmap */
+enum simak65_heat {
+	simak65_heat_fetch,
+	simak65_heat_read,
+	simak65_heat_write,
+	simak65_heat_stack
+};
+
+#define SIMAK65_HEAT_KINDS 4
+
+/* Byte classes, bits set once accessed that way */
+#define SIMAK65_CLASS_EXEC    0x01
+#define SIMAK65_CLASS_DATA    0x02
+#define SIMAK65_CLASS_WRITTEN 0x04
+
+/* Memory access counters per 256-byte page and optionally per byte */
+struct simak65_heatmap {
+	uint64_t pages[256][SIMAK65_HEAT_KINDS];
+	/* NULL unless created with per byte counters */
+	uint64_t (*bytes)[SIMAK65_HEAT_KINDS];
+	/* SIMAK65_CLASS_* bits of every byte */
+	uint8_t classes[0x10000];
+};
+
+/* Per-address execution profile */
+struct simak65_profile {
+	uint64_t insns[0x10000];
+	uint64_t cycles[0x10000];
+};
 
 struct simak65_cpu {
 	struct {
@@ -23,11 +153,92 @@ struct simak65_cpu {
 		void (*write)(uint16_t address, uint8_t byte);
 	} bus;
 	unsigned long cycles;
+	/* Performance counters, not counting if built with SIMAK65_NO_PERF */
+	struct simak65_perf perf;
+
+	/* Pages written since the last snapshot, one bit per 256-byte page */
+	uint32_t dirty[8];
+	/* Last snapshot taken or restored, base for the next delta */
+	struct simak65_snapshot *snap;
+
+	/* I/O pages, one bit per 256-byte page */
+	uint32_t io[8];
+	/* Memory behind the bus for all other pages, NULL if not known */
+	uint8_t *ram;
+	/* Copy or fill loop being measured, internal */
+	struct {
+		int armed;
+		uint16_t branch;
+		uint8_t index;
+		unsigned long cycles;
+		struct simak65_perf perf;
+		/* End of the run, no loop is skipped past it */
+		unsigned long end;
+	} idiom;
+	/* Input log, recording or replaying */
+	struct simak65_log *log;
+	/* Checkpoints for reverse execution */
+	struct simak65_reverse *rev;
+	/* Instruction trace ring */
+	struct simak65_trace *trace;
+	/* Instruction trace file */
+	struct simak65_tracefile *tracefile;
+	/* Execution profile */
+	struct simak65_profile *profile;
+	/* Call graph profile */
+	struct simak65_callgraph *callgraph;
+	/* Sampling profiler */
+	struct simak65_sampler *sampler;
+	/* Memory access heatmap */
+	struct simak65_heatmap *heatmap;
+	/* Shared memory metrics updated by simak65_run() */
+	struct simak65_metrics *metrics;
+	/* Native routine traps, NULL if none is set */
+	struct simak65_traps *traps;
+	/* Recompiled ROM image, NULL if none */
+	const struct simak65_aot *aot;
+	/* Subroutine result cache and the cache recording a call, internal */
+	struct simak65_memo *memo;
+	struct simak65_memo *memo_rec;
+	/* Where a traced step collects the instruction bytes, internal */
+	uint8_t *fetched;
+	/* Registers published by simak65_run() under a seqlock, every interval
+	 * cycles if not zero */
+	struct {
+		uint32_t seq;
+		struct simak65_regs regs;
+		unsigned long interval;
+		unsigned long next;
+	} pub;
+	/* Per-instruction features enabled and the cycle simak65_step()
+	 * leaves its fast path at, internal */
+	unsigned int hooks;
+	unsigned long hook_at;
+
+	/* Breakpoint bitmap, NULL if none is armed */
+	uint8_t *breakpoints;
+	unsigned int nbreakpoints;
+	/* Watchpoint bitmaps, NULL if none is armed */
+	uint8_t *watch_read;
+	uint8_t *watch_write;
+	/* Last watchpoint hit, pc of the instruction is set by simak65_run() */
+	struct {
+		uint16_t pc;
+		uint16_t addr;
+		uint8_t write;
+	} watch;
+	/* Reason simak65_run() returned */
+	enum simak65_stop stop;
 };
 
 /* Execute next instruction */
 void simak65_step(struct simak65_cpu *cpu);
 
+/* Execute instructions for at least the given number of cycles, until
+ * a breakpoint is hit or after an instruction hits a watchpoint.
+ * A breakpoint at the starting point is ignored, so it can be resumed from. */
+enum simak65_stop simak65_run(struct simak65_cpu *cpu, unsigned long cycles);
+
 /* Execute reset */
 void simak65_rst(struct simak65_cpu *cpu);
 
@@ -40,4 +251,231 @@ void simak65_irq(struct simak65_cpu *cpu);
 /* Perform core initialization (excluding CPU reset) */
 void simak65_init(struct simak65_cpu *cpu);
 
+/* Take a snapshot of the CPU state and memory. The first snapshot holds
+ * every page, next ones only pages written since the previous snapshot
+ * taken or restored on this CPU. Returns NULL on allocation failure. */
+struct simak65_snapshot *simak65_snapshot_take(struct simak65_cpu *cpu);
+
+/* Restore CPU state and memory from the snapshot delta chain */
+void simak65_snapshot_restore(struct simak65_cpu *cpu, struct simak65_snapshot *snap);
+
+/* Drop the reference to the snapshot, chain is freed when unused */
+void simak65_snapshot_free(struct simak65_snapshot *snap);
+
+/* Forget the previous snapshot, next one will be full */
+void simak65_snapshot_reset(struct simak65_cpu *cpu);
+
+/* Arm a breakpoint, returns -1 on allocation failure */
+int simak65_break_set(struct simak65_cpu *cpu, uint16_t addr);
+
+void simak65_break_clear(struct simak65_cpu *cpu, uint16_t addr);
+
+void simak65_break_clear_all(struct simak65_cpu *cpu);
+
+/* Returns non-zero if a breakpoint is armed at the current PC */
+int simak65_break_hit(struct simak65_cpu *cpu);
+
+/* Watch data accesses to start - end, type is a mask of SIMAK65_WATCH_*.
+ * Returns -1 on allocation failure */
+int simak65_watch_set(struct simak65_cpu *cpu, uint16_t start, uint16_t end, int type);
+
+void simak65_watch_clear(struct simak65_cpu *cpu, uint16_t start, uint16_t end, int type);
+
+/* Mark (io != 0) or unmark pages overlapping start - end as I/O pages */
+void simak65_io(struct simak65_cpu *cpu, uint16_t start, uint16_t end, int io);
+
+/* Declare the 64 KiB array the bus callbacks access for all pages not
+ * marked as I/O, block copy and fill loops then run natively. NULL stops. */
+void simak65_ram(struct simak65_cpu *cpu, uint8_t *ram);
+
+/* Start logging I/O page reads and interrupt delivery to the stream */
+int simak65_record(struct simak65_cpu *cpu, FILE *f);
+
+/* Start replaying the log, I/O pages and interrupts are served from it */
+int simak65_replay(struct simak65_cpu *cpu, FILE *f);
+
+/* Stop recording or replaying, returns -1 if the log got out of sync */
+int simak65_log_stop(struct simak65_cpu *cpu);
+
+/* Start recording history for reverse execution to an empty read/write
+ * stream, keeping up to count checkpoints spaced by interval cycles */
+int simak65_reverse_start(struct simak65_cpu *cpu, FILE *f, unsigned long interval, unsigned int count);
+
+/* Stop recording history, the CPU stays at the current point */
+void simak65_reverse_stop(struct simak65_cpu *cpu);
+
+/* Go back one instruction, returns -1 if out of history */
+int simak65_reverse_step(struct simak65_cpu *cpu);
+
+/* Go back to the last point where stop() returned non-zero, or the last
+ * breakpoint hit if stop is NULL. Returns -1 and stops at the oldest
+ * checkpoint if not found */
+int simak65_reverse_continue(struct simak65_cpu *cpu, int (*stop)(struct simak65_cpu *cpu));
+
+/* Create an instruction trace ring of 2^order records */
+struct simak65_trace *simak65_trace_create(unsigned int order);
+
+/* Free the trace ring, it must not be attached to a running CPU */
+void simak65_trace_destroy(struct simak65_trace *trace);
+
+/* Start tracing to the ring, NULL stops tracing. May be called from any thread */
+void simak65_trace_attach(struct simak65_cpu *cpu, struct simak65_trace *trace);
+
+/* Copy up to count most recent records, oldest first, returns the number of
+ * records copied. May be called from any thread while the CPU runs */
+unsigned int simak65_trace_read(struct simak65_trace *trace, struct simak65_trace_rec *recs, unsigned int count);
+
+/* Create a trace file, records are compressed and written in background */
+struct simak65_tracefile *simak65_tracefile_create(const char *path);
+
+/* Flush the trace, write the index and close the file, returns -1 on error */
+int simak65_tracefile_close(struct simak65_tracefile *tf);
+
+/* Start tracing to the file, NULL stops tracing */
+void simak65_tracefile_attach(struct simak65_cpu *cpu, struct simak65_tracefile *tf);
+
+/* Map a trace file for reading, positioned at the first record */
+struct simak65_tracemap *simak65_tracemap_open(const char *path);
+
+void simak65_tracemap_close(struct simak65_tracemap *tm);
+
+/* Read the next record, returns -1 at the end of the trace */
+int simak65_tracemap_next(struct simak65_tracemap *tm, struct simak65_trace_rec *rec);
+
+/* Position at the instruction executing at the given cycle, returns -1
+ * and positions at the start if the trace begins later */
+int simak65_tracemap_seek(struct simak65_tracemap *tm, uint64_t cycles);
+
+/* Position at the next execution of the address, returns -1 if none */
+int simak65_tracemap_find_pc(struct simak65_tracemap *tm, uint16_t pc);
+
+struct simak65_profile *simak65_profile_create(void);
+
+void simak65_profile_destroy(struct simak65_profile *prof);
+
+/* Start counting instructions and cycles per address, NULL stops */
+void simak65_profile_attach(struct simak65_cpu *cpu, struct simak65_profile *prof);
+
+void simak65_profile_reset(struct simak65_profile *prof);
+
+/* Write raw counters, 64-bit little endian, instructions then cycles */
+int simak65_profile_write(const struct simak65_profile *prof, FILE *f);
+
+/* Write a text report of executed addresses, disassembled from the cpu
+ * memory if given, returns -1 on error */
+int simak65_profile_report(const struct simak65_profile *prof, struct simak65_cpu *cpu, FILE *f);
+
+struct simak65_callgraph *simak65_callgraph_create(void);
+
+void simak65_callgraph_destroy(struct simak65_callgraph *cg);
+
+/* Start tracking calls and interrupts with a new shadow stack, NULL stops */
+void simak65_callgraph_attach(struct simak65_cpu *cpu, struct simak65_callgraph *cg);
+
+void simak65_callgraph_reset(struct simak65_callgraph *cg);
+
+/* Write exclusive cycles per call path as collapsed stacks */
+int simak65_callgraph_write(const struct simak65_callgraph *cg, FILE *f);
+
+/* Write calls, inclusive and exclusive cycles per routine */
+int simak65_callgraph_report(const struct simak65_callgraph *cg, FILE *f);
+
+/* Create a sampler keeping the newest count samples of the executing
+ * address, taken on average every interval cycles */
+struct simak65_sampler *simak65_sampler_create(unsigned int count, unsigned long interval);
+
+void simak65_sampler_destroy(struct simak65_sampler *s);
+
+/* Start sampling, NULL stops */
+void simak65_sampler_attach(struct simak65_cpu *cpu, struct simak65_sampler *s);
+
+/* Move up to count oldest unread samples to pcs, returns their number. Safe
+ * from a single reader thread while the CPU runs. */
+unsigned int simak65_sampler_read(struct simak65_sampler *s, uint16_t *pcs, unsigned int count);
+
+/* Create a heatmap, with per byte counters if bytes is set */
+struct simak65_heatmap *simak65_heatmap_create(int bytes);
+
+void simak65_heatmap_destroy(struct simak65_heatmap *heat);
+
+/* Start counting memory accesses, NULL stops */
+void simak65_heatmap_attach(struct simak65_cpu *cpu, struct simak65_heatmap *heat);
+
+void simak65_heatmap_reset(struct simak65_heatmap *heat);
+
+/* Write counters and classes of the accessed pages, returns -1 on error */
+int simak65_heatmap_write(const struct simak65_heatmap *heat, FILE *f);
+
+/* Copy the performance counters */
+void simak65_perf_read(const struct simak65_cpu *cpu, struct simak65_perf *perf);
+
+void simak65_perf_reset(struct simak65_cpu *cpu);
+
+/* Create a POSIX shared memory metrics block, e.g. "/simak65-<pid>",
+ * updated by simak65_run() every interval cycles */
+struct simak65_metrics *simak65_metrics_create(const char *name, unsigned long interval);
+
+/* Open a metrics block of another process for reading */
+struct simak65_metrics *simak65_metrics_open(const char *name);
+
+/* Unmap the block, removes it if created by this process */
+void simak65_metrics_destroy(struct simak65_metrics *m);
+
+/* Start publishing metrics, NULL stops */
+void simak65_metrics_attach(struct simak65_cpu *cpu, struct simak65_metrics *m);
+
+/* Read a consistent sample, returns -1 if the writer kept updating it */
+int simak65_metrics_read(const struct simak65_metrics *m, struct simak65_metrics_sample *sample);
+
+/* Publish registers from simak65_run() every interval cycles and when it
+ * returns, 0 stops */
+void simak65_regs_interval(struct simak65_cpu *cpu, unsigned long interval);
+
+/* Publish registers now, from the thread running the CPU */
+void simak65_regs_publish(struct simak65_cpu *cpu);
+
+/* Read the last published registers, safe from any thread */
+void simak65_regs_read(const struct simak65_cpu *cpu, struct simak65_regs *regs);
+
+/* Cache of subroutine results */
+struct simak65_memo *simak65_memo_create(void);
+
+void simak65_memo_destroy(struct simak65_memo *memo);
+
+/* Start answering repeated subroutine calls from the cache, NULL stops */
+void simak65_memo_attach(struct simak65_cpu *cpu, struct simak65_memo *memo);
+
+/* Drop the cached results and statistics */
+void simak65_memo_reset(struct simak65_memo *memo);
+
+/* Write calls, cache hits and cached entries per routine */
+int simak65_memo_report(const struct simak65_memo *memo, FILE *f);
+
+/* Run fn instead of the subroutine at addr, it returns as with RTS */
+int simak65_trap_set(struct simak65_cpu *cpu, uint16_t addr, simak65_trap_fn fn, void *arg);
+
+void simak65_trap_clear(struct simak65_cpu *cpu, uint16_t addr);
+
+void simak65_trap_clear_all(struct simak65_cpu *cpu);
+
+/* Run the recompiled blocks of the image from simak65_run(), the bus has to
+ * return the image. NULL stops. Returns -1 if the memory differs. */
+int simak65_aot_attach(struct simak65_cpu *cpu, const struct simak65_aot *aot);
+
+/* Memory access for traps, going through dirty tracking, watchpoints and
+ * the input log as guest accesses do */
+uint8_t simak65_mem_read(struct simak65_cpu *cpu, uint16_t addr);
+
+void simak65_mem_write(struct simak65_cpu *cpu, uint16_t addr, uint8_t data);
+
+/* Replay the recorded log segments between consecutive snapshots on
+ * parallel threads (0 - one per core), checking each one ends in the state
+ * of the next snapshot. Returns 0 if all match, 1 with the first diverging
+ * segment set if not, -1 on error. */
+int simak65_verify(const char *path, struct simak65_snapshot **cps, unsigned int count, unsigned int threads, unsigned int *segment);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* SIMAK65_H_ */
@@ -0,0 +1,529 @@
+/* SimAK65 C++ core
+ * Copyright A.K. 2026
+ *
+ * Header-only interpreter templated on a bus policy with static
+ * Bus::read(addr) and Bus::write(addr, data), so that a flat memory bus
+ * compiles down to plain loads and stores. It decodes with the library's
+ * opcode table and computes with its ALU; registers, flags, cycles and
+ * the order of bus accesses are those of simak65_step(). The optional
+ * features (hooks, traces, breakpoints, counters) are C API only.
+ * Include it from the library sources (-I) or as <simak65/simak65.hpp>
+ * once installed, and link with libsimak65.a in both cases.
+ */
+
+#ifndef SIMAK65_HPP_
+#define SIMAK65_HPP_
+
+#include <stdint.h>
+
+extern "C" {
+#include "decoder.h"
+#include "alu.h"
+#include "flags.h"
+}
+
+namespace simak65 {
+
+template <class Bus>
+class Cpu {
+public:
+	struct {
+		uint16_t pc;
+		uint8_t a;
+		uint8_t x;
+		uint8_t y;
+		uint8_t sp;
+		uint8_t flags;
+	} reg;
+	unsigned long cycles;
+
+	/* As simak65_init(), registers cleared without a reset */
+	Cpu() : cycles(0)
+	{
+		reg.pc = 0;
+		reg.a = 0;
+		reg.x = 0;
+		reg.y = 0;
+		reg.sp = 0;
+		reg.flags = 0;
+	}
+
+	void rst()
+	{
+		reg.a = 0;
+		reg.x = 0;
+		reg.y = 0;
+		reg.flags = FLAG_ONE;
+		reg.sp = 0xff;
+		reg.pc = vector(RST_VECTOR);
+		cycles += 4;
+	}
+
+	void nmi()
+	{
+		interrupt(NMI_VECTOR);
+	}
+
+	void irq()
+	{
+		interrupt(IRQ_VECTOR);
+	}
+
+	/* Execute the next instruction */
+	void step()
+	{
+		uint8_t opcode = fetch();
+		struct opinfo info = decoder_table[opcode];
+		uint16_t addr = 0;
+		uint8_t arg = 0;
+		enum argtype type = args(info.mode, addr, arg);
+
+		execute(info.opcode, type, addr, arg);
+	}
+
+	/* Execute instructions for at least the given number of cycles */
+	void run(unsigned long n)
+	{
+		unsigned long end = cycles + n;
+
+		while (cycles < end)
+			step();
+	}
+
+private:
+	enum argtype { arg_none, arg_byte, arg_addr };
+
+	enum {
+		NMI_VECTOR = 0xfffa,
+		RST_VECTOR = 0xfffc,
+		IRQ_VECTOR = 0xfffe
+	};
+
+	uint8_t fetch()
+	{
+		return Bus::read(reg.pc++);
+	}
+
+	uint16_t fetch16()
+	{
+		uint16_t addr = fetch();
+
+		return addr | (uint16_t)(fetch() << 8);
+	}
+
+	uint16_t vector(uint16_t addr)
+	{
+		uint16_t pc = Bus::read(addr);
+
+		return pc | (uint16_t)(Bus::read(addr + 1) << 8);
+	}
+
+	void push(uint8_t data)
+	{
+		Bus::write(0x0100 | reg.sp--, data);
+	}
+
+	uint8_t pop()
+	{
+		return Bus::read(0x0100 | ++reg.sp);
+	}
+
+	void interrupt(uint16_t vec)
+	{
+		push(reg.pc >> 8);
+		push(reg.pc & 0xff);
+		push((reg.flags | FLAG_ONE) & ~FLAG_BRK);
+		reg.pc = vector(vec);
+		reg.flags |= FLAG_IRQD;
+		cycles += 7;
+	}
+
+	/* Operand per addressing mode, same costs as addrmode.h */
+	enum argtype args(enum addrmode mode, uint16_t &addr, uint8_t &arg)
+	{
+		uint16_t ptr;
+
+		switch (mode) {
+			case mode_acc:
+				arg = reg.a;
+				return arg_byte;
+
+			case mode_abs:
+				addr = fetch16();
+				cycles += 3;
+				return arg_addr;
+
+			case mode_abx:
+				addr = fetch16() + reg.x;
+				cycles += 3;
+				return arg_addr;
+
+			case mode_aby:
+				addr = fetch16() + reg.y;
+				cycles += 3;
+				return arg_addr;
+
+			case mode_imm:
+				arg = fetch();
+				cycles += 1;
+				return arg_byte;
+
+			case mode_ind:
+				ptr = fetch16();
+				addr = Bus::read(ptr);
+				addr |= (uint16_t)(Bus::read(ptr + 1) << 8);
+				cycles += 7;
+				return arg_addr;
+
+			case mode_inx:
+				ptr = (uint8_t)(fetch() + reg.x);
+				addr = Bus::read(ptr);
+				addr |= (uint16_t)(Bus::read(ptr + 1) << 8);
+				cycles += 5;
+				return arg_addr;
+
+			case mode_iny:
+				ptr = fetch();
+				addr = Bus::read(ptr);
+				addr |= (uint16_t)(Bus::read(ptr + 1) << 8);
+				addr += reg.y;
+				cycles += 5;
+				return arg_addr;
+
+			case mode_rel:
+				arg = fetch();
+				addr = reg.pc + (int8_t)arg;
+				cycles += 1;
+				return arg_addr;
+
+			case mode_zp:
+				addr = fetch();
+				cycles += 2;
+				return arg_addr;
+
+			case mode_zpx:
+				addr = (uint8_t)(fetch() + reg.x);
+				cycles += 2;
+				return arg_addr;
+
+			case mode_zpy:
+				addr = (uint8_t)(fetch() + reg.y);
+				cycles += 2;
+				return arg_addr;
+
+			default:
+				return arg_none;
+		}
+	}
+
+	uint8_t load(enum argtype type, uint16_t addr, uint8_t arg)
+	{
+		if (type == arg_addr) {
+			cycles += 2;
+			return Bus::read(addr);
+		}
+
+		cycles += 1;
+
+		return arg;
+	}
+
+	/* Read-modify-write on memory or the accumulator */
+	void modify(u8 (*op)(u8, u8, u8 *), enum argtype type, uint16_t addr, uint8_t arg)
+	{
+		uint8_t result = op(load(type, addr, arg), 0, &reg.flags);
+
+		if (type == arg_addr) {
+			Bus::write(addr, result);
+			cycles += 1;
+		}
+		else {
+			reg.a = result;
+		}
+	}
+
+	void branch(bool taken, uint16_t addr)
+	{
+		if (taken) {
+			reg.pc = addr;
+			cycles += 1;
+		}
+	}
+
+	void execute(enum opcode insn, enum argtype type, uint16_t addr, uint8_t arg)
+	{
+		uint16_t pc;
+
+		switch (insn) {
+			case ADC:
+				arg = load(type, addr, arg);
+				reg.a = alu_add(reg.a, arg, &reg.flags);
+				break;
+
+			case AND:
+				reg.a = alu_and(reg.a, load(type, addr, arg), &reg.flags);
+				break;
+
+			case ASL:
+				modify(alu_asl, type, addr, arg);
+				break;
+
+			case BCC:
+				branch(!(reg.flags & FLAG_CARRY), addr);
+				break;
+
+			case BCS:
+				branch(reg.flags & FLAG_CARRY, addr);
+				break;
+
+			case BEQ:
+				branch(reg.flags & FLAG_ZERO, addr);
+				break;
+
+			case BIT:
+				alu_bit(reg.a, load(type, addr, arg), &reg.flags);
+				break;
+
+			case BMI:
+				branch(reg.flags & FLAG_SIGN, addr);
+				break;
+
+			case BNE:
+				branch(!(reg.flags & FLAG_ZERO), addr);
+				break;
+
+			case BPL:
+				branch(!(reg.flags & FLAG_SIGN), addr);
+				break;
+
+			case BRK:
+				reg.pc += 1;
+				push(reg.pc >> 8);
+				push(reg.pc & 0xff);
+				push(reg.flags | FLAG_ONE | FLAG_BRK);
+				reg.flags |= FLAG_IRQD;
+				reg.pc = vector(IRQ_VECTOR);
+				cycles += 4;
+				break;
+
+			case BVC:
+				branch(!(reg.flags & FLAG_OVRF), addr);
+				break;
+
+			case BVS:
+				branch(reg.flags & FLAG_OVRF, addr);
+				break;
+
+			case CLC:
+				reg.flags &= ~FLAG_CARRY;
+				cycles += 1;
+				break;
+
+			case CLD:
+				reg.flags &= ~FLAG_BCD;
+				cycles += 1;
+				break;
+
+			case CLI:
+				reg.flags &= ~FLAG_IRQD;
+				cycles += 1;
+				break;
+
+			case CLV:
+				reg.flags &= ~FLAG_OVRF;
+				cycles += 1;
+				break;
+
+			case CMP:
+				alu_cmp(reg.a, load(type, addr, arg), &reg.flags);
+				break;
+
+			case CPX:
+				alu_cmp(reg.x, load(type, addr, arg), &reg.flags);
+				break;
+
+			case CPY:
+				alu_cmp(reg.y, load(type, addr, arg), &reg.flags);
+				break;
+
+			case DEC:
+				modify(alu_dec, type, addr, arg);
+				break;
+
+			case DEX:
+				reg.x = alu_dec(reg.x, 0, &reg.flags);
+				cycles += 1;
+				break;
+
+			case DEY:
+				reg.y = alu_dec(reg.y, 0, &reg.flags);
+				cycles += 1;
+				break;
+
+			case EOR:
+				reg.a = alu_eor(reg.a, load(type, addr, arg), &reg.flags);
+				break;
+
+			case INC:
+				modify(alu_inc, type, addr, arg);
+				break;
+
+			case INX:
+				reg.x = alu_inc(reg.x, 0, &reg.flags);
+				cycles += 1;
+				break;
+
+			case INY:
+				reg.y = alu_inc(reg.y, 0, &reg.flags);
+				cycles += 1;
+				break;
+
+			case JMP:
+				reg.pc = addr;
+				cycles += 1;
+				break;
+
+			case JSR:
+				pc = reg.pc - 1;
+				push(pc >> 8);
+				push(pc & 0xff);
+				reg.pc = addr;
+				cycles += 2;
+				break;
+
+			case LDA:
+				reg.a = alu_load(load(type, addr, arg), 0, &reg.flags);
+				break;
+
+			case LDX:
+				reg.x = alu_load(load(type, addr, arg), 0, &reg.flags);
+				break;
+
+			case LDY:
+				reg.y = alu_load(load(type, addr, arg), 0, &reg.flags);
+				break;
+
+			case LSR:
+				modify(alu_lsr, type, addr, arg);
+				break;
+
+			case NOP:
+				cycles += 1;
+				break;
+
+			case ORA:
+				reg.a = alu_or(reg.a, load(type, addr, arg), &reg.flags);
+				break;
+
+			case PHA:
+				push(reg.a);
+				cycles += 2;
+				break;
+
+			case PHP:
+				push(reg.flags | FLAG_ONE | FLAG_BRK);
+				cycles += 2;
+				break;
+
+			case PLA:
+				reg.a = alu_load(pop(), 0, &reg.flags);
+				cycles += 2;
+				break;
+
+			case PLP:
+				reg.flags = pop() & (FLAG_CARRY | FLAG_ZERO | FLAG_IRQD | FLAG_BCD | FLAG_OVRF | FLAG_SIGN);
+				cycles += 2;
+				break;
+
+			case ROL:
+				modify(alu_rol, type, addr, arg);
+				break;
+
+			case ROR:
+				modify(alu_ror, type, addr, arg);
+				break;
+
+			case RTI:
+				reg.flags = pop() & (FLAG_CARRY | FLAG_ZERO | FLAG_IRQD | FLAG_BCD | FLAG_OVRF | FLAG_SIGN);
+				pc = pop();
+				reg.pc = pc | (uint16_t)(pop() << 8);
+				cycles += 3;
+				break;
+
+			case RTS:
+				pc = pop();
+				reg.pc = (pc | (uint16_t)(pop() << 8)) + 1;
+				cycles += 2;
+				break;
+
+			case SBC:
+				arg = load(type, addr, arg);
+				reg.a = alu_sub(reg.a, arg, &reg.flags);
+				break;
+
+			case SEC:
+				reg.flags |= FLAG_CARRY;
+				cycles += 1;
+				break;
+
+			case SED:
+				reg.flags |= FLAG_BCD;
+				cycles += 1;
+				break;
+
+			case SEI:
+				reg.flags |= FLAG_IRQD;
+				cycles += 1;
+				break;
+
+			case STA:
+				Bus::write(addr, reg.a);
+				cycles += 2;
+				break;
+
+			case STX:
+				Bus::write(addr, reg.x);
+				cycles += 2;
+				break;
+
+			case STY:
+				Bus::write(addr, reg.y);
+				cycles += 2;
+				break;
+
+			case TAX:
+				reg.x = alu_load(reg.a, 0, &reg.flags);
+				cycles += 1;
+				break;
+
+			case TAY:
+				reg.y = alu_load(reg.a, 0, &reg.flags);
+				cycles += 1;
+				break;
+
+			case TSX:
+				reg.x = alu_load(reg.sp, 0, &reg.flags);
+				cycles += 1;
+				break;
+
+			case TXA:
+				reg.a = alu_load(reg.x, 0, &reg.flags);
+				cycles += 1;
+				break;
+
+			case TXS:
+				reg.sp = reg.x;
+				cycles += 1;
+				break;
+
+			case TYA:
+				reg.a = alu_load(reg.y, 0, &reg.flags);
+				cycles += 1;
+				break;
+		}
+	}
+};
+
+}
+
+#endif /* SIMAK65_HPP_ */
@@ -0,0 +1,208 @@
+/* SimAK65 snapshots
+ * Copyright A.K. 2026
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "error.h"
+#include "snapshot.h"
+#include "log.h"
+#include "memo.h"
+#include "idiom.h"
+#include "simak65.h"
+
+struct simak65_snapshot *snapshot_get(struct simak65_snapshot *snap)
+{
+	if (snap != NULL)
+		++snap->refs;
+
+	return snap;
+}
+
+struct simak65_snapshot *simak65_snapshot_take(struct simak65_cpu *cpu)
+{
+	struct simak65_snapshot *snap;
+	unsigned int page, npages = 0, i;
+	u32 pages[SNAPSHOT_PAGES / 32];
+	u8 *data;
+	u16 addr;
+
+	for (i = 0; i < SNAPSHOT_PAGES / 32; ++i) {
+		pages[i] = (cpu->snap == NULL) ? 0xffffffff : cpu->dirty[i];
+		pages[i] &= ~cpu->io[i];
+		npages += __builtin_popcount(pages[i]);
+	}
+
+	snap = malloc(sizeof(*snap));
+	if (snap != NULL) {
+		snap->data = malloc(npages * SNAPSHOT_PAGE_SIZE);
+		if (snap->data == NULL && npages != 0) {
+			free(snap);
+			snap = NULL;
+		}
+	}
+
+	if (snap == NULL) {
+		WARN("Snapshot allocation failed");
+		return NULL;
+	}
+
+	snap->prev = snapshot_get(cpu->snap);
+	snap->refs = 1;
+	snap->pc = cpu->reg.pc;
+	snap->a = cpu->reg.a;
+	snap->x = cpu->reg.x;
+	snap->y = cpu->reg.y;
+	snap->sp = cpu->reg.sp;
+	snap->flags = cpu->reg.flags;
+	snap->cycles = cpu->cycles;
+	snap->logpos = (cpu->log != NULL) ? cpu->log->pos : 0;
+	memcpy(snap->io, cpu->io, sizeof(snap->io));
+	memcpy(snap->pages, pages, sizeof(pages));
+	snap->npages = npages;
+
+	data = snap->data;
+	for (page = 0; page < SNAPSHOT_PAGES; ++page) {
+		if (!snapshot_has(pages, page))
+			continue;
+
+		addr = page << 8;
+		for (i = 0; i < SNAPSHOT_PAGE_SIZE; ++i)
+			*data++ = cpu->bus.read(addr + i);
+	}
+
+	DEBUG("Snapshot at cycle %lu, %u pages", snap->cycles, npages);
+
+	memset(cpu->dirty, 0, sizeof(cpu->dirty));
+	simak65_snapshot_free(cpu->snap);
+	cpu->snap = snapshot_get(snap);
+
+	return snap;
+}
+
+const u8 *snapshot_page(const struct simak65_snapshot *snap, unsigned int page)
+{
+	unsigned int i, index;
+
+	for (; snap != NULL; snap = snap->prev) {
+		if (!snapshot_has(snap->pages, page))
+			continue;
+
+		index = 0;
+		for (i = 0; i < (page >> 5); ++i)
+			index += __builtin_popcount(snap->pages[i]);
+		index += __builtin_popcount(snap->pages[page >> 5] & (((u32)1 << (page & 0x1f)) - 1));
+
+		return snap->data + index * SNAPSHOT_PAGE_SIZE;
+	}
+
+	return NULL;
+}
+
+int snapshot_fold(struct simak65_snapshot *snap)
+{
+	const struct simak65_snapshot *delta;
+	u32 pages[SNAPSHOT_PAGES / 32] = { 0 };
+	unsigned int page, npages = 0, i;
+	u8 *data, *dst;
+
+	if (snap->prev == NULL)
+		return 0;
+
+	for (delta = snap; delta != NULL; delta = delta->prev) {
+		for (i = 0; i < SNAPSHOT_PAGES / 32; ++i)
+			pages[i] |= delta->pages[i];
+	}
+
+	for (i = 0; i < SNAPSHOT_PAGES / 32; ++i)
+		npages += __builtin_popcount(pages[i]);
+
+	data = malloc(npages * SNAPSHOT_PAGE_SIZE);
+	if (data == NULL && npages != 0) {
+		WARN("Snapshot allocation failed");
+		return -1;
+	}
+
+	dst = data;
+	for (page = 0; page < SNAPSHOT_PAGES; ++page) {
+		if (!snapshot_has(pages, page))
+			continue;
+
+		memcpy(dst, snapshot_page(snap, page), SNAPSHOT_PAGE_SIZE);
+		dst += SNAPSHOT_PAGE_SIZE;
+	}
+
+	free(snap->data);
+	snap->data = data;
+	memcpy(snap->pages, pages, sizeof(pages));
+	snap->npages = npages;
+
+	simak65_snapshot_free(snap->prev);
+	snap->prev = NULL;
+
+	return 0;
+}
+
+void simak65_snapshot_restore(struct simak65_cpu *cpu, struct simak65_snapshot *snap)
+{
+	const struct simak65_snapshot *delta;
+	u32 done[SNAPSHOT_PAGES / 32] = { 0 };
+	unsigned int page, i;
+	const u8 *data;
+	u16 addr;
+
+	memo_abort(cpu);
+	idiom_reset(cpu);
+
+	/* Newest copy of every page wins, walk the chain from the top */
+	for (delta = snap; delta != NULL; delta = delta->prev) {
+		data = delta->data;
+		for (page = 0; page < SNAPSHOT_PAGES; ++page) {
+			if (!snapshot_has(delta->pages, page))
+				continue;
+
+			if (!snapshot_has(done, page)) {
+				done[page >> 5] |= (u32)1 << (page & 0x1f);
+
+				addr = page << 8;
+				for (i = 0; i < SNAPSHOT_PAGE_SIZE; ++i)
+					cpu->bus.write(addr + i, data[i]);
+			}
+
+			data += SNAPSHOT_PAGE_SIZE;
+		}
+	}
+
+	cpu->reg.pc = snap->pc;
+	cpu->reg.a = snap->a;
+	cpu->reg.x = snap->x;
+	cpu->reg.y = snap->y;
+	cpu->reg.sp = snap->sp;
+	cpu->reg.flags = snap->flags;
+	cpu->cycles = snap->cycles;
+
+	DEBUG("Restored snapshot from cycle %lu", snap->cycles);
+
+	memset(cpu->dirty, 0, sizeof(cpu->dirty));
+	snapshot_get(snap);
+	simak65_snapshot_free(cpu->snap);
+	cpu->snap = snap;
+}
+
+void simak65_snapshot_free(struct simak65_snapshot *snap)
+{
+	struct simak65_snapshot *prev;
+
+	while (snap != NULL && --snap->refs == 0) {
+		prev = snap->prev;
+		free(snap->data);
+		free(snap);
+		snap = prev;
+	}
+}
+
+void simak65_snapshot_reset(struct simak65_cpu *cpu)
+{
+	simak65_snapshot_free(cpu->snap);
+	cpu->snap = NULL;
+}
@@ -0,0 +1,49 @@
+/* SimAK65 snapshots
+ * Copyright A.K. 2026
+ */
+
+#ifndef SIMAK65_SNAPSHOT_H_
+#define SIMAK65_SNAPSHOT_H_
+
+#include "types.h"
+#include "simak65.h"
+
+#define SNAPSHOT_PAGES 256
+#define SNAPSHOT_PAGE_SIZE 256
+
+struct simak65_snapshot {
+	struct simak65_snapshot *prev;
+	unsigned int refs;
+
+	u16 pc;
+	u8 a;
+	u8 x;
+	u8 y;
+	u8 sp;
+	u8 flags;
+	unsigned long cycles;
+
+	/* Input log offset, if a log was attached */
+	unsigned long logpos;
+	u32 io[SNAPSHOT_PAGES / 32];
+
+	/* Pages held by this delta, data is stored in ascending page order */
+	u32 pages[SNAPSHOT_PAGES / 32];
+	unsigned int npages;
+	u8 *data;
+};
+
+static inline int snapshot_has(const u32 *bitmap, unsigned int page)
+{
+	return !!(bitmap[page >> 5] & ((u32)1 << (page & 0x1f)));
+}
+
+struct simak65_snapshot *snapshot_get(struct simak65_snapshot *snap);
+
+/* Newest copy of the page in the delta chain, NULL if not saved */
+const u8 *snapshot_page(const struct simak65_snapshot *snap, unsigned int page);
+
+/* Merge the whole chain into the snapshot, making it a full one */
+int snapshot_fold(struct simak65_snapshot *snap);
+
+#endif /* SIMAK65_SNAPSHOT_H_ */
@@ -0,0 +1,238 @@
+/* SimAK65 C++ core benchmark
+ * Copyright A.K. 2026
+ *
+ * Runs the workloads of simak65-bench on the C run engine and on
+ * simak65::Cpu with the same buses as static policies, for the same
+ * number of cycles. Both execute the same instructions, the count of the
+ * C++ core stands in when performance counting is compiled out. Final
+ * registers, cycles and memory of both are compared, a difference is
+ * reported and makes the exit status non-zero.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <simak65.h>
+#include "simak65.hpp"
+#include "simak65-bench.h"
+
+static uint8_t mem[0x10000];
+
+/* State a run ends in */
+struct result {
+	uint16_t pc;
+	uint8_t a, x, y, sp, flags;
+	unsigned long cycles;
+	uint8_t mem[0x10000];
+};
+
+static struct result res_c, res_cxx;
+
+/* Page table as in a banked machine, writes to the top 16 KiB are dropped */
+static uint8_t *pages[256];
+static uint8_t writable[256];
+
+struct FlatBus {
+	static uint8_t read(uint16_t addr)
+	{
+		return mem[addr];
+	}
+
+	static void write(uint16_t addr, uint8_t data)
+	{
+		mem[addr] = data;
+	}
+};
+
+struct PagedBus {
+	static uint8_t read(uint16_t addr)
+	{
+		return pages[addr >> 8][addr & 0xff];
+	}
+
+	static void write(uint16_t addr, uint8_t data)
+	{
+		if (writable[addr >> 8])
+			pages[addr >> 8][addr & 0xff] = data;
+	}
+};
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Works for both struct simak65_cpu and simak65::Cpu */
+template <class Cpu>
+static void save(const Cpu &cpu, struct result *r)
+{
+	r->pc = cpu.reg.pc;
+	r->a = cpu.reg.a;
+	r->x = cpu.reg.x;
+	r->y = cpu.reg.y;
+	r->sp = cpu.reg.sp;
+	r->flags = cpu.reg.flags;
+	r->cycles = cpu.cycles;
+	memcpy(r->mem, mem, sizeof(mem));
+}
+
+static int compare(const char *workload, const char *bus)
+{
+	const struct result *a = &res_c, *b = &res_cxx;
+	unsigned int i;
+
+	if (a->pc != b->pc || a->a != b->a || a->x != b->x || a->y != b->y || a->sp != b->sp ||
+			a->flags != b->flags || a->cycles != b->cycles) {
+		fprintf(stderr, "%s,%s: run pc=%04x a=%02x x=%02x y=%02x sp=%02x p=%02x cycles=%lu, "
+			"cxx pc=%04x a=%02x x=%02x y=%02x sp=%02x p=%02x cycles=%lu\n", workload, bus,
+			a->pc, a->a, a->x, a->y, a->sp, a->flags, a->cycles,
+			b->pc, b->a, b->x, b->y, b->sp, b->flags, b->cycles);
+		return -1;
+	}
+
+	for (i = 0; i < sizeof(a->mem); ++i) {
+		if (a->mem[i] != b->mem[i]) {
+			fprintf(stderr, "%s,%s: memory at 0x%04x is %02x on run, %02x on cxx\n", workload, bus,
+				i, a->mem[i], b->mem[i]);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static void setup(const struct workload *w)
+{
+	unsigned int i;
+
+	memset(mem, 0, sizeof(mem));
+	memcpy(mem + ORIGIN, w->code, w->size);
+	for (i = 0; i < 0x400; ++i)
+		mem[0x1000 + i] = i * 7;
+	mem[0x30] = w->seed;
+	mem[0xfffc] = ORIGIN & 0xff;
+	mem[0xfffd] = ORIGIN >> 8;
+
+	for (i = 0; i < 256; ++i) {
+		pages[i] = mem + (i << 8);
+		writable[i] = (i < 0xc0);
+	}
+}
+
+/* C library, fast path of simak65_run() */
+template <class Bus>
+static double measure_c(const struct workload *w, unsigned long *cycles, uint64_t *insns)
+{
+	struct simak65_cpu cpu;
+	struct simak65_perf perf;
+	unsigned long start;
+	double t;
+
+	setup(w);
+	cpu.bus.read = Bus::read;
+	cpu.bus.write = Bus::write;
+	simak65_init(&cpu);
+	simak65_rst(&cpu);
+	simak65_perf_reset(&cpu);
+	start = cpu.cycles;
+
+	t = now();
+	simak65_run(&cpu, *cycles);
+	t = now() - t;
+
+	simak65_perf_read(&cpu, &perf);
+	*insns = perf.instructions;
+	*cycles = cpu.cycles - start;
+	save(cpu, &res_c);
+
+	return t;
+}
+
+/* Same loop as Cpu::run(), counting instructions */
+template <class Bus>
+static double measure_cxx(const struct workload *w, unsigned long *cycles, uint64_t *insns)
+{
+	simak65::Cpu<Bus> cpu;
+	unsigned long start, end;
+	uint64_t n = 0;
+	double t;
+
+	setup(w);
+	cpu.rst();
+	start = cpu.cycles;
+	end = start + *cycles;
+
+	t = now();
+	while (cpu.cycles < end) {
+		cpu.step();
+		++n;
+	}
+	t = now() - t;
+
+	*insns = n;
+	*cycles = cpu.cycles - start;
+	save(cpu, &res_cxx);
+
+	return t;
+}
+
+static void report(const char *workload, const char *engine, const char *bus, uint64_t insns, unsigned long cycles, double t)
+{
+	printf("%s,%s,%s,%llu,%lu,%.6f,%.0f,%.0f,%.3f\n", workload, engine, bus,
+		(unsigned long long)insns, cycles, t, insns / t, cycles / t, t * 1e9 / insns);
+	fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned long budget = 100000000, cycles, ccxx;
+	const struct workload *w;
+	unsigned int i;
+	uint64_t insns, count;
+	double t, tcxx;
+	int opt, status = 0;
+
+	while ((opt = getopt(argc, argv, "c:h")) != -1) {
+		switch (opt) {
+			case 'c':
+				budget = strtoul(optarg, NULL, 0);
+				break;
+
+			default:
+				fprintf(stderr, "Usage: %s [-c cycles]\n", argv[0]);
+				return (opt == 'h') ? 0 : 1;
+		}
+	}
+
+	printf("workload,engine,bus,instructions,cycles,seconds,ips,cps,ns_per_insn\n");
+
+	for (i = 0; i < sizeof(workloads) / sizeof(workloads[0]); ++i) {
+		w = &workloads[i];
+
+		cycles = budget;
+		t = measure_c<FlatBus>(w, &cycles, &insns);
+		ccxx = budget;
+		tcxx = measure_cxx<FlatBus>(w, &ccxx, &count);
+		report(w->name, "run", "flat", (insns != 0) ? insns : count, cycles, t);
+		report(w->name, "cxx", "flat", count, ccxx, tcxx);
+		if (compare(w->name, "flat") < 0)
+			status = 1;
+
+		cycles = budget;
+		t = measure_c<PagedBus>(w, &cycles, &insns);
+		ccxx = budget;
+		tcxx = measure_cxx<PagedBus>(w, &ccxx, &count);
+		report(w->name, "run", "paged", (insns != 0) ? insns : count, cycles, t);
+		report(w->name, "cxx", "paged", count, ccxx, tcxx);
+		if (compare(w->name, "paged") < 0)
+			status = 1;
+	}
+
+	return status;
+}
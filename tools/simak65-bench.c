@@ -0,0 +1,166 @@
+/* SimAK65 benchmark
+ * Copyright A.K. 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <simak65.h>
+#include "simak65-bench.h"
+
+static uint8_t mem[0x10000];
+
+/* Flat RAM */
+static uint8_t flat_read(uint16_t addr)
+{
+	return mem[addr];
+}
+
+static void flat_write(uint16_t addr, uint8_t data)
+{
+	mem[addr] = data;
+}
+
+/* Page table as in a banked machine, writes to the top 16 KiB are dropped */
+static uint8_t *pages[256];
+static uint8_t writable[256];
+
+static uint8_t paged_read(uint16_t addr)
+{
+	return pages[addr >> 8][addr & 0xff];
+}
+
+static void paged_write(uint16_t addr, uint8_t data)
+{
+	if (writable[addr >> 8])
+		pages[addr >> 8][addr & 0xff] = data;
+}
+
+struct bus {
+	const char *name;
+	uint8_t (*read)(uint16_t addr);
+	void (*write)(uint16_t addr, uint8_t data);
+	/* Declare mem with simak65_ram() */
+	int ram;
+};
+
+static const struct bus buses[] = {
+	{ "flat", flat_read, flat_write, 0 },
+	{ "paged", paged_read, paged_write, 0 },
+	{ "ram", flat_read, flat_write, 1 }
+};
+
+static const char *engines[] = { "step", "run" };
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void setup(struct simak65_cpu *cpu, const struct workload *w, const struct bus *bus)
+{
+	unsigned int i;
+
+	memset(mem, 0, sizeof(mem));
+	memcpy(mem + ORIGIN, w->code, w->size);
+	for (i = 0; i < 0x400; ++i)
+		mem[0x1000 + i] = i * 7;
+	mem[0x30] = w->seed;
+	mem[0xfffc] = ORIGIN & 0xff;
+	mem[0xfffd] = ORIGIN >> 8;
+
+	for (i = 0; i < 256; ++i) {
+		pages[i] = mem + (i << 8);
+		writable[i] = (i < 0xc0);
+	}
+
+	cpu->bus.read = bus->read;
+	cpu->bus.write = bus->write;
+	simak65_init(cpu);
+	if (bus->ram)
+		simak65_ram(cpu, mem);
+	simak65_rst(cpu);
+}
+
+/* Execute count instructions by stepping, or the same number of cycles
+ * with simak65_run(), returns the elapsed time */
+static double measure(struct simak65_cpu *cpu, int engine, unsigned long count, unsigned long *cycles, uint64_t *insns)
+{
+	unsigned long start = cpu->cycles, i;
+	struct simak65_perf perf;
+	double t;
+
+	simak65_perf_reset(cpu);
+	t = now();
+
+	if (engine == 0) {
+		for (i = 0; i < count; ++i)
+			simak65_step(cpu);
+	}
+	else {
+		simak65_run(cpu, *cycles);
+	}
+
+	t = now() - t;
+
+	/* Without performance counting the run engine count is unknown */
+	simak65_perf_read(cpu, &perf);
+	*insns = (perf.instructions != 0 || engine != 0) ? perf.instructions : count;
+	*cycles = cpu->cycles - start;
+
+	return t;
+}
+
+int main(int argc, char *argv[])
+{
+	struct simak65_cpu cpu;
+	unsigned long count = 20000000, cycles;
+	unsigned int w, b, e;
+	uint64_t insns;
+	double t;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "n:h")) != -1) {
+		switch (opt) {
+			case 'n':
+				count = strtoul(optarg, NULL, 0);
+				break;
+
+			default:
+				fprintf(stderr, "Usage: %s [-n instructions]\n", argv[0]);
+				return (opt == 'h') ? 0 : 1;
+		}
+	}
+
+	printf("workload,engine,bus,instructions,cycles,seconds,ips,cps,ns_per_insn\n");
+
+	for (w = 0; w < sizeof(workloads) / sizeof(workloads[0]); ++w) {
+		for (b = 0; b < sizeof(buses) / sizeof(buses[0]); ++b) {
+			/* The step engine sets the cycle budget of the run engine */
+			cycles = 0;
+
+			for (e = 0; e < sizeof(engines) / sizeof(engines[0]); ++e) {
+				setup(&cpu, &workloads[w], &buses[b]);
+				t = measure(&cpu, e, count, &cycles, &insns);
+
+				if (insns != 0) {
+					printf("%s,%s,%s,%llu,%lu,%.6f,%.0f,%.0f,%.3f\n", workloads[w].name, engines[e], buses[b].name,
+						(unsigned long long)insns, cycles, t, insns / t, cycles / t, t * 1e9 / insns);
+				}
+				else {
+					printf("%s,%s,%s,-,%lu,%.6f,-,%.0f,-\n", workloads[w].name, engines[e], buses[b].name,
+						cycles, t, cycles / t);
+				}
+				fflush(stdout);
+			}
+		}
+	}
+
+	return 0;
+}
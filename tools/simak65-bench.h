@@ -0,0 +1,131 @@
+/* SimAK65 benchmark workloads
+ * Copyright A.K. 2026
+ */
+
+#ifndef SIMAK65_BENCH_H_
+#define SIMAK65_BENCH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ORIGIN 0x0200
+
+struct workload {
+	const char *name;
+	const uint8_t *code;
+	size_t size;
+	/* Zero page initialisation */
+	uint8_t seed;
+};
+
+/* Register arithmetic and shifts */
+static const uint8_t alu[] = {
+	0xa9, 0x00,       /* 0200 lda #$00 */
+	0x18,             /* 0202 clc */
+	0x69, 0x07,       /* 0203 adc #$07 */
+	0x49, 0x5a,       /* 0205 eor #$5a */
+	0x0a,             /* 0207 asl a */
+	0x2a,             /* 0208 rol a */
+	0xe8,             /* 0209 inx */
+	0xc8,             /* 020a iny */
+	0x4c, 0x02, 0x02  /* 020b jmp $0202 */
+};
+
+/* Copy 4 pages from $1000 to $2000 with (zp),y */
+static const uint8_t memcpy_zp[] = {
+	0xa9, 0x00,       /* 0200 lda #$00 */
+	0x85, 0x10,       /* 0202 sta $10 */
+	0x85, 0x12,       /* 0204 sta $12 */
+	0xa9, 0x10,       /* 0206 lda #$10 */
+	0x85, 0x11,       /* 0208 sta $11 */
+	0xa9, 0x20,       /* 020a lda #$20 */
+	0x85, 0x13,       /* 020c sta $13 */
+	0xa2, 0x04,       /* 020e ldx #$04 */
+	0xa0, 0x00,       /* 0210 ldy #$00 */
+	0xb1, 0x10,       /* 0212 lda ($10),y */
+	0x91, 0x12,       /* 0214 sta ($12),y */
+	0xc8,             /* 0216 iny */
+	0xd0, 0xf9,       /* 0217 bne $0212 */
+	0xe6, 0x11,       /* 0219 inc $11 */
+	0xe6, 0x13,       /* 021b inc $13 */
+	0xca,             /* 021d dex */
+	0xd0, 0xf2,       /* 021e bne $0212 */
+	0x4c, 0x00, 0x02  /* 0220 jmp $0200 */
+};
+
+/* Binary tree of calls, depth 10 */
+static const uint8_t recursion[] = {
+	0xa2, 0xff,       /* 0200 ldx #$ff */
+	0x9a,             /* 0202 txs */
+	0xa9, 0x0a,       /* 0203 lda #$0a */
+	0x20, 0x0b, 0x02, /* 0205 jsr $020b */
+	0x4c, 0x00, 0x02, /* 0208 jmp $0200 */
+	0xc9, 0x00,       /* 020b cmp #$00 */
+	0xf0, 0x0b,       /* 020d beq $021a */
+	0x48,             /* 020f pha */
+	0x38,             /* 0210 sec */
+	0xe9, 0x01,       /* 0211 sbc #$01 */
+	0x20, 0x0b, 0x02, /* 0213 jsr $020b */
+	0x20, 0x0b, 0x02, /* 0216 jsr $020b */
+	0x68,             /* 0219 pla */
+	0x60              /* 021a rts */
+};
+
+/* Decimal mode counter */
+static const uint8_t bcd[] = {
+	0xf8,             /* 0200 sed */
+	0x18,             /* 0201 clc */
+	0xa9, 0x00,       /* 0202 lda #$00 */
+	0x69, 0x01,       /* 0204 adc #$01 */
+	0x85, 0x20,       /* 0206 sta $20 */
+	0xa5, 0x21,       /* 0208 lda $21 */
+	0x69, 0x00,       /* 020a adc #$00 */
+	0x85, 0x21,       /* 020c sta $21 */
+	0x38,             /* 020e sec */
+	0xa5, 0x20,       /* 020f lda $20 */
+	0xe9, 0x03,       /* 0211 sbc #$03 */
+	0x18,             /* 0213 clc */
+	0xa5, 0x20,       /* 0214 lda $20 */
+	0x4c, 0x04, 0x02  /* 0216 jmp $0204 */
+};
+
+/* Bubble sort of 64 pseudo-random bytes at $0300 */
+static const uint8_t sort[] = {
+	0xa2, 0x3f,       /* 0200 ldx #$3f */
+	0xa5, 0x30,       /* 0202 lda $30 */
+	0x0a,             /* 0204 asl a */
+	0x90, 0x02,       /* 0205 bcc $0209 */
+	0x49, 0x1d,       /* 0207 eor #$1d */
+	0x85, 0x30,       /* 0209 sta $30 */
+	0x9d, 0x00, 0x03, /* 020b sta $0300,x */
+	0xca,             /* 020e dex */
+	0x10, 0xf1,       /* 020f bpl $0202 */
+	0xa0, 0x00,       /* 0211 ldy #$00 */
+	0xa2, 0x00,       /* 0213 ldx #$00 */
+	0xbd, 0x00, 0x03, /* 0215 lda $0300,x */
+	0xdd, 0x01, 0x03, /* 0218 cmp $0301,x */
+	0x90, 0x11,       /* 021b bcc $022e */
+	0xf0, 0x0f,       /* 021d beq $022e */
+	0x85, 0x31,       /* 021f sta $31 */
+	0xbd, 0x01, 0x03, /* 0221 lda $0301,x */
+	0x9d, 0x00, 0x03, /* 0224 sta $0300,x */
+	0xa5, 0x31,       /* 0227 lda $31 */
+	0x9d, 0x01, 0x03, /* 0229 sta $0301,x */
+	0xa0, 0x01,       /* 022c ldy #$01 */
+	0xe8,             /* 022e inx */
+	0xe0, 0x3f,       /* 022f cpx #$3f */
+	0xd0, 0xe2,       /* 0231 bne $0215 */
+	0xc0, 0x00,       /* 0233 cpy #$00 */
+	0xd0, 0xda,       /* 0235 bne $0211 */
+	0x4c, 0x00, 0x02  /* 0237 jmp $0200 */
+};
+
+static const struct workload workloads[] = {
+	{ "alu", alu, sizeof(alu), 0 },
+	{ "memcpy", memcpy_zp, sizeof(memcpy_zp), 0 },
+	{ "recursion", recursion, sizeof(recursion), 0 },
+	{ "bcd", bcd, sizeof(bcd), 0 },
+	{ "sort", sort, sizeof(sort), 0xa5 }
+};
+
+#endif /* SIMAK65_BENCH_H_ */
@@ -0,0 +1,771 @@
+/* SimAK65 differential conformance checker
+ * Copyright A.K. 2026
+ *
+ * Runs randomized single instruction cases and long random programs on a
+ * reference and a candidate engine, comparing every bus access and the
+ * state after each instruction. Engines running several instructions per
+ * step are compared where they stop, the other one is stepped up to the
+ * same cycle. Built with CONFORM_AOT and an image recompiled from the ROM
+ * written with -r, programs hold that ROM and the aot engine runs its
+ * blocks.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <simak65.h>
+#include "decoder.h"
+#include "aot.h"
+
+#define ACCESS_MAX 2048
+#define OVERLAY_MAX 16
+
+/* Budget of a fused engine step, well above the 32 cycles a fused sequence
+ * may take, so that simak65_run() enters them */
+#define FUSED_CYCLES 256
+
+/* Same for the aot engine and the blocks */
+#define AOT_RUN_CYCLES (AOT_CYCLES * 4)
+
+/* ROM written with -r, up to the end of memory */
+#define ROM_BASE 0x8000
+
+/* Opcode sequences planted in random programs */
+#define SEQ_MAX 1024
+
+struct access {
+	uint16_t addr;
+	uint8_t data;
+	uint8_t write;
+};
+
+/* Memory and bus log of one CPU instance */
+struct ctx {
+	/* Full memory, or NULL for hash-backed memory with a write overlay */
+	uint8_t *mem;
+	uint64_t seed;
+	struct access overlay[OVERLAY_MAX];
+	unsigned int noverlay;
+
+	struct access log[ACCESS_MAX];
+	unsigned int nlog;
+	unsigned int lost;
+};
+
+struct state {
+	uint16_t pc;
+	uint8_t a;
+	uint8_t x;
+	uint8_t y;
+	uint8_t sp;
+	uint8_t flags;
+	unsigned long cycles;
+};
+
+struct engine {
+	const char *name;
+	void (*attach)(struct simak65_cpu *cpu);
+	void (*step)(struct simak65_cpu *cpu);
+	/* A step may run more than one instruction */
+	int multi;
+	/* Runs the blocks recompiled from the ROM */
+	int aot;
+};
+
+#ifdef CONFORM_AOT
+extern const struct simak65_aot conform_rom;
+#endif
+
+/* Bus callbacks have no context, the instance being stepped is per thread */
+static __thread struct ctx *current;
+static __thread struct simak65_profile *profile;
+
+static const struct engine *ref, *cand;
+static unsigned long ncases = 1000000, nprograms = 64, length = 100000;
+static unsigned int nthreads;
+static FILE *dump;
+static pthread_mutex_t dump_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint8_t seqs[SEQ_MAX][3];
+static unsigned int seqlen[SEQ_MAX], nseqs;
+/* Writes from here on are dropped */
+static uint32_t rom_base = 0x10000;
+
+/* Work is handed out in chunks, stopping at the first divergence */
+static unsigned long next_case, next_program;
+static int failed;
+static pthread_mutex_t report_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static uint64_t rng_next(uint64_t *s)
+{
+	/* xorshift64* */
+	*s ^= *s >> 12;
+	*s ^= *s << 25;
+	*s ^= *s >> 27;
+
+	return *s * 0x2545f4914f6cdd1dULL;
+}
+
+static uint8_t hash_byte(uint64_t seed, uint16_t addr)
+{
+	uint64_t h = (seed ^ addr) * 0x9e3779b97f4a7c15ULL;
+
+	return (h ^ (h >> 29)) >> 24;
+}
+
+static uint8_t ctx_peek(const struct ctx *c, uint16_t addr)
+{
+	unsigned int i;
+
+	if (c->mem != NULL)
+		return c->mem[addr];
+
+	for (i = c->noverlay; i-- > 0;) {
+		if (c->overlay[i].addr == addr)
+			return c->overlay[i].data;
+	}
+
+	return hash_byte(c->seed, addr);
+}
+
+static void ctx_log(struct ctx *c, uint16_t addr, uint8_t data, int write)
+{
+	if (c->nlog == ACCESS_MAX) {
+		c->lost++;
+		return;
+	}
+
+	c->log[c->nlog].addr = addr;
+	c->log[c->nlog].data = data;
+	c->log[c->nlog].write = write;
+	c->nlog++;
+}
+
+static uint8_t conform_read(uint16_t addr)
+{
+	uint8_t data = ctx_peek(current, addr);
+
+	ctx_log(current, addr, data, 0);
+
+	return data;
+}
+
+static void conform_write(uint16_t addr, uint8_t data)
+{
+	struct ctx *c = current;
+
+	ctx_log(c, addr, data, 1);
+
+	if (c->mem != NULL) {
+		if (addr < rom_base)
+			c->mem[addr] = data;
+	}
+	else if (c->noverlay < OVERLAY_MAX)
+		c->overlay[c->noverlay++] = (struct access){ addr, data, 1 };
+	else
+		c->lost++;
+}
+
+static void attach_none(struct simak65_cpu *cpu)
+{
+	(void)cpu;
+}
+
+static void attach_profile(struct simak65_cpu *cpu)
+{
+	simak65_profile_attach(cpu, profile);
+}
+
+static void step_step(struct simak65_cpu *cpu)
+{
+	simak65_step(cpu);
+}
+
+static void step_run(struct simak65_cpu *cpu)
+{
+	/* Every instruction takes at least a cycle, so this is one step */
+	simak65_run(cpu, 1);
+}
+
+static void step_fused(struct simak65_cpu *cpu)
+{
+	simak65_run(cpu, FUSED_CYCLES);
+}
+
+#ifdef CONFORM_AOT
+static void step_aot(struct simak65_cpu *cpu)
+{
+	simak65_run(cpu, AOT_RUN_CYCLES);
+}
+#endif
+
+static const struct engine engines[] = {
+	/* simak65_step() fast path */
+	{ "step", attach_none, step_step, 0, 0 },
+	/* simak65_step() with a per-instruction hook attached, the profiler
+	 * does not access the bus */
+	{ "hooked", attach_profile, step_step, 0, 0 },
+	/* simak65_run() */
+	{ "run", attach_none, step_run, 0, 0 },
+	/* simak65_run() through the fused sequences */
+	{ "fused", attach_none, step_fused, 1, 0 },
+#ifdef CONFORM_AOT
+	/* simak65_run() through the recompiled blocks */
+	{ "aot", attach_none, step_aot, 1, 1 },
+#endif
+};
+
+static void state_get(const struct simak65_cpu *cpu, struct state *s)
+{
+	s->pc = cpu->reg.pc;
+	s->a = cpu->reg.a;
+	s->x = cpu->reg.x;
+	s->y = cpu->reg.y;
+	s->sp = cpu->reg.sp;
+	s->flags = cpu->reg.flags;
+	s->cycles = cpu->cycles;
+}
+
+static void state_set(struct simak65_cpu *cpu, const struct state *s)
+{
+	cpu->reg.pc = s->pc;
+	cpu->reg.a = s->a;
+	cpu->reg.x = s->x;
+	cpu->reg.y = s->y;
+	cpu->reg.sp = s->sp;
+	cpu->reg.flags = s->flags;
+	cpu->cycles = s->cycles;
+}
+
+static void state_random(struct state *s, uint64_t *rng)
+{
+	uint64_t r = rng_next(rng);
+
+	s->pc = r;
+	s->a = r >> 16;
+	s->x = r >> 24;
+	s->y = r >> 32;
+	s->sp = r >> 40;
+	/* Bit 5 always reads as one */
+	s->flags = (r >> 48) | 0x20;
+	s->cycles = 0;
+}
+
+static int state_equal(const struct state *a, const struct state *b)
+{
+	return a->pc == b->pc && a->a == b->a && a->x == b->x && a->y == b->y &&
+		a->sp == b->sp && a->flags == b->flags && a->cycles == b->cycles;
+}
+
+static int log_equal(const struct ctx *a, const struct ctx *b)
+{
+	return a->nlog == b->nlog && a->lost == b->lost &&
+		memcmp(a->log, b->log, a->nlog * sizeof(a->log[0])) == 0;
+}
+
+static void state_print(FILE *f, const char *label, const struct state *s)
+{
+	fprintf(f, "%s pc=%04x a=%02x x=%02x y=%02x sp=%02x p=%02x cycles=%lu", label,
+		s->pc, s->a, s->x, s->y, s->sp, s->flags, s->cycles);
+}
+
+static void log_print(FILE *f, const struct ctx *c)
+{
+	unsigned int i;
+
+	for (i = 0; i < c->nlog; ++i)
+		fprintf(f, " %c%04x=%02x", c->log[i].write ? 'w' : 'r', c->log[i].addr, c->log[i].data);
+
+	if (c->lost)
+		fprintf(f, " +%u lost", c->lost);
+}
+
+static void report(const char *what, uint64_t seed, unsigned long step, const struct state *pre,
+		const struct state *ra, const struct ctx *ca, const struct state *rb, const struct ctx *cb)
+{
+	pthread_mutex_lock(&report_lock);
+
+	if (!__atomic_exchange_n(&failed, 1, __ATOMIC_ACQ_REL)) {
+		printf("DIVERGED %s seed=%llu step=%lu\n", what, (unsigned long long)seed, step);
+		state_print(stdout, "  before   ", pre);
+		printf("\n");
+		state_print(stdout, "  ", ra);
+		printf(" [%s]\n   bus", ref->name);
+		log_print(stdout, ca);
+		printf("\n");
+		state_print(stdout, "  ", rb);
+		printf(" [%s]\n   bus", cand->name);
+		log_print(stdout, cb);
+		printf("\n");
+		fflush(stdout);
+	}
+
+	pthread_mutex_unlock(&report_lock);
+}
+
+/* Step one engine until end, the context is reset to record this step
+ * only */
+static void run_one(const struct engine *e, struct simak65_cpu *cpu, struct ctx *c, int irq, unsigned long end)
+{
+	c->nlog = 0;
+	c->lost = 0;
+	current = c;
+
+	if (irq == 1)
+		simak65_irq(cpu);
+	else if (irq == 2)
+		simak65_nmi(cpu);
+
+	do
+		e->step(cpu);
+	while (cpu->cycles < end);
+}
+
+/* Step both engines over the same instructions, the one running several
+ * per step goes first */
+static void run_both(struct simak65_cpu *cpa, struct ctx *ca, struct simak65_cpu *cpb, struct ctx *cb, int irq)
+{
+	if (cand->multi && !ref->multi) {
+		run_one(cand, cpb, cb, irq, 0);
+		run_one(ref, cpa, ca, irq, cpb->cycles);
+	}
+	else {
+		run_one(ref, cpa, ca, irq, 0);
+		run_one(cand, cpb, cb, irq, cpa->cycles);
+	}
+}
+
+static void cpu_prepare(struct simak65_cpu *cpu, const struct engine *e)
+{
+	cpu->bus.read = conform_read;
+	cpu->bus.write = conform_write;
+	simak65_init(cpu);
+	e->attach(cpu);
+}
+
+static void cpu_release(struct simak65_cpu *cpu)
+{
+	simak65_profile_attach(cpu, NULL);
+	simak65_aot_attach(cpu, NULL);
+}
+
+#ifdef CONFORM_AOT
+/* Blocks are accepted once the memory holds their image */
+static int cpu_rom(struct simak65_cpu *cpu, const struct engine *e, struct ctx *c)
+{
+	current = c;
+
+	if (!e->aot || simak65_aot_attach(cpu, &conform_rom) == 0)
+		return 0;
+
+	printf("Recompiled image rejected by %s\n", e->name);
+	__atomic_store_n(&failed, 1, __ATOMIC_RELAXED);
+
+	return -1;
+}
+#endif
+
+/* Turn the random bytes from start to end into random code, every other
+ * instruction being one of the planted sequences if there are any. The
+ * operands stay random. If documented is set, no byte is an undocumented
+ * opcode, so that code is found wherever the static analysis starts. */
+static void code_fill(uint8_t *mem, uint32_t start, uint32_t end, uint64_t *rng, int documented)
+{
+	unsigned int i, j;
+	uint64_t r;
+
+	for (i = start; documented && i < end; ++i) {
+		while (decoder_table[mem[i]].opcode == NOP && mem[i] != 0xea)
+			mem[i] = rng_next(rng);
+	}
+
+	for (i = start; i + 8 < end;) {
+		r = rng_next(rng);
+		if (nseqs != 0 && (r & 1)) {
+			r = (r >> 1) % nseqs;
+			for (j = 0; j < seqlen[r]; ++j) {
+				mem[i] = seqs[r][j];
+				i += decode_length(seqs[r][j]);
+			}
+		}
+		else {
+			i += decode_length(mem[i]);
+		}
+	}
+}
+
+static void single_case(uint64_t seed, struct simak65_cpu *cpa, struct simak65_cpu *cpb,
+		struct ctx *ca, struct ctx *cb)
+{
+	struct state pre, ra, rb;
+	uint64_t rng = seed * 2 + 1;
+
+	state_random(&pre, &rng);
+
+	ca->mem = NULL;
+	ca->seed = rng_next(&rng);
+	ca->noverlay = 0;
+	cb->mem = NULL;
+	cb->seed = ca->seed;
+	cb->noverlay = 0;
+
+	state_set(cpa, &pre);
+	state_set(cpb, &pre);
+
+	run_both(cpa, ca, cpb, cb, 0);
+
+	state_get(cpa, &ra);
+	state_get(cpb, &rb);
+
+	if (!state_equal(&ra, &rb) || !log_equal(ca, cb)) {
+		report("single", seed, 0, &pre, &ra, ca, &rb, cb);
+		return;
+	}
+
+	if (dump != NULL) {
+		pthread_mutex_lock(&dump_lock);
+		fprintf(dump, "%llu op=%02x", (unsigned long long)seed, hash_byte(ca->seed, pre.pc));
+		state_print(dump, " in", &pre);
+		state_print(dump, " out", &ra);
+		fprintf(dump, " bus");
+		log_print(dump, ca);
+		fprintf(dump, "\n");
+		pthread_mutex_unlock(&dump_lock);
+	}
+}
+
+static void program_case(uint64_t seed, struct simak65_cpu *cpa, struct simak65_cpu *cpb,
+		struct ctx *ca, struct ctx *cb)
+{
+	struct state pre, ra, rb;
+	uint64_t rng = seed * 2 + 1, r;
+	unsigned long step;
+	unsigned int i;
+	int irq;
+
+	for (i = 0; i < 0x10000; i += 8) {
+		r = rng_next(&rng);
+		memcpy(ca->mem + i, &r, 8);
+	}
+
+	if (nseqs != 0)
+		code_fill(ca->mem, 0, 0x10000, &rng, 0);
+#ifdef CONFORM_AOT
+	memcpy(ca->mem + conform_rom.base, conform_rom.image, conform_rom.size);
+#endif
+	memcpy(cb->mem, ca->mem, 0x10000);
+
+#ifdef CONFORM_AOT
+	if (cpu_rom(cpa, ref, ca) < 0 || cpu_rom(cpb, cand, cb) < 0)
+		return;
+#endif
+
+	state_random(&pre, &rng);
+	state_set(cpa, &pre);
+	state_set(cpb, &pre);
+
+	for (step = 0; step < length; ++step) {
+		/* Occasional interrupts, delivered to both before the step */
+		r = rng_next(&rng);
+		irq = ((r & 0x3f) == 0) ? 1 + ((r >> 6) & 1) : 0;
+
+		state_get(cpa, &pre);
+		run_both(cpa, ca, cpb, cb, irq);
+
+		state_get(cpa, &ra);
+		state_get(cpb, &rb);
+
+		/* Same writes from the same memory keep the memories equal */
+		if (!state_equal(&ra, &rb) || !log_equal(ca, cb)) {
+			report("program", seed, step, &pre, &ra, ca, &rb, cb);
+			return;
+		}
+
+		if (__atomic_load_n(&failed, __ATOMIC_RELAXED))
+			return;
+	}
+
+	if (memcmp(ca->mem, cb->mem, 0x10000) != 0)
+		report("program memory", seed, step, &pre, &ra, ca, &rb, cb);
+}
+
+static void *worker(void *arg)
+{
+	struct simak65_cpu cpa, cpb;
+	struct ctx *ca, *cb;
+	unsigned long i, start;
+	uint8_t *mem;
+
+	(void)arg;
+
+	ca = calloc(2, sizeof(*ca));
+	mem = malloc(2 * 0x10000);
+	profile = simak65_profile_create();
+	if (ca == NULL || mem == NULL || profile == NULL) {
+		fprintf(stdout, "Out of memory\n");
+		__atomic_store_n(&failed, 1, __ATOMIC_RELAXED);
+		free(ca);
+		free(mem);
+		simak65_profile_destroy(profile);
+		return NULL;
+	}
+	cb = ca + 1;
+
+	cpu_prepare(&cpa, ref);
+	cpu_prepare(&cpb, cand);
+
+	while (!__atomic_load_n(&failed, __ATOMIC_RELAXED)) {
+		start = __atomic_fetch_add(&next_case, 4096, __ATOMIC_RELAXED);
+		if (start >= ncases)
+			break;
+
+		for (i = start; i < start + 4096 && i < ncases; ++i)
+			single_case(i, &cpa, &cpb, ca, cb);
+	}
+
+	ca->mem = mem;
+	cb->mem = mem + 0x10000;
+
+	while (!__atomic_load_n(&failed, __ATOMIC_RELAXED)) {
+		i = __atomic_fetch_add(&next_program, 1, __ATOMIC_RELAXED);
+		if (i >= nprograms)
+			break;
+
+		program_case(i, &cpa, &cpb, ca, cb);
+	}
+
+	cpu_release(&cpa);
+	cpu_release(&cpb);
+	simak65_profile_destroy(profile);
+	free(mem);
+	free(ca);
+
+	return NULL;
+}
+
+static const struct engine *engine_find(const char *name)
+{
+	unsigned int i;
+
+	for (i = 0; i < sizeof(engines) / sizeof(engines[0]); ++i) {
+		if (strcmp(engines[i].name, name) == 0)
+			return &engines[i];
+	}
+
+	fprintf(stderr, "Unknown engine %s\n", name);
+
+	return NULL;
+}
+
+/* Read opcode sequences as printed by simak65-seq */
+static int seqs_load(const char *path)
+{
+	char line[256], *p, *end;
+	unsigned long op;
+	FILE *f;
+
+	f = fopen(path, "r");
+	if (f == NULL) {
+		perror(path);
+		return -1;
+	}
+
+	while (nseqs < SEQ_MAX && fgets(line, sizeof(line), f) != NULL) {
+		if (line[0] == '#')
+			continue;
+
+		/* Count first */
+		strtoul(line, &p, 10);
+		seqlen[nseqs] = 0;
+
+		while (seqlen[nseqs] < 3) {
+			op = strtoul(p, &end, 16);
+			if (end == p || op > 0xff)
+				break;
+			seqs[nseqs][seqlen[nseqs]++] = op;
+			p = end;
+		}
+
+		if (seqlen[nseqs] != 0)
+			nseqs++;
+	}
+
+	fclose(f);
+
+	return 0;
+}
+
+/* Write a ROM of random documented code, vectors pointing into it */
+static int rom_write(const char *path)
+{
+	static uint8_t mem[0x10000];
+	static uint16_t starts[0x10000];
+	uint64_t rng = 1, r;
+	unsigned int i, n = 0;
+	FILE *f;
+
+	for (i = ROM_BASE; i < 0x10000; i += 8) {
+		r = rng_next(&rng);
+		memcpy(mem + i, &r, 8);
+	}
+
+	code_fill(mem, ROM_BASE, 0xfffa, &rng, 1);
+
+	for (i = ROM_BASE; i + 8 < 0xfffa; i += decode_length(mem[i]))
+		starts[n++] = i;
+
+	for (i = 0xfffa; i < 0x10000; i += 2) {
+		r = starts[rng_next(&rng) % n];
+		mem[i] = r;
+		mem[i + 1] = r >> 8;
+	}
+
+	f = fopen(path, "wb");
+	if (f == NULL) {
+		perror(path);
+		return -1;
+	}
+
+	if (fwrite(mem + ROM_BASE, 1, 0x10000 - ROM_BASE, f) != 0x10000 - ROM_BASE || fclose(f) != 0) {
+		fprintf(stderr, "Could not write %s\n", path);
+		return -1;
+	}
+
+	return 0;
+}
+
+static void usage(const char *prog)
+{
+	unsigned int i;
+
+	fprintf(stderr, "Usage: %s [-a engine] [-b engine] [-n cases] [-p programs] [-l length] [-t threads] [-o file] [-s file] [-r file] [-v]\n", prog);
+	fprintf(stderr, "  -a/-b  reference and candidate engine\n");
+	fprintf(stderr, "  -n     single instruction cases\n");
+	fprintf(stderr, "  -p -l  random programs and their length in steps\n");
+	fprintf(stderr, "  -t     threads, 0 for one per core\n");
+	fprintf(stderr, "  -o     write the single instruction cases run on the reference\n");
+	fprintf(stderr, "  -s     plant the opcode sequences of a simak65-seq output in random programs\n");
+	fprintf(stderr, "  -r     write a ROM of random code to recompile for the aot engine and exit\n");
+	fprintf(stderr, "  -v     keep library warnings\n");
+	fprintf(stderr, "Engines:");
+	for (i = 0; i < sizeof(engines) / sizeof(engines[0]); ++i)
+		fprintf(stderr, " %s", engines[i].name);
+	fprintf(stderr, "\n");
+}
+
+int main(int argc, char *argv[])
+{
+	pthread_t *threads;
+	const char *rom = NULL;
+	unsigned int i;
+	int opt, verbose = 0, fd;
+
+	ref = &engines[0];
+	cand = &engines[1];
+
+	while ((opt = getopt(argc, argv, "a:b:n:p:l:t:o:s:r:vh")) != -1) {
+		switch (opt) {
+			case 'a':
+				if ((ref = engine_find(optarg)) == NULL)
+					return 1;
+				break;
+
+			case 'b':
+				if ((cand = engine_find(optarg)) == NULL)
+					return 1;
+				break;
+
+			case 'n':
+				ncases = strtoul(optarg, NULL, 0);
+				break;
+
+			case 'p':
+				nprograms = strtoul(optarg, NULL, 0);
+				break;
+
+			case 'l':
+				length = strtoul(optarg, NULL, 0);
+				break;
+
+			case 't':
+				nthreads = strtoul(optarg, NULL, 0);
+				break;
+
+			case 'o':
+				dump = fopen(optarg, "w");
+				if (dump == NULL) {
+					perror(optarg);
+					return 1;
+				}
+				break;
+
+			case 's':
+				if (seqs_load(optarg) < 0)
+					return 1;
+				break;
+
+			case 'r':
+				rom = optarg;
+				break;
+
+			case 'v':
+				verbose = 1;
+				break;
+
+			default:
+				usage(argv[0]);
+				return (opt == 'h') ? 0 : 1;
+		}
+	}
+
+	if (rom != NULL)
+		return (rom_write(rom) < 0) ? 1 : 0;
+
+#ifdef CONFORM_AOT
+	rom_base = conform_rom.base;
+#endif
+
+	if (nthreads == 0) {
+		nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+		if ((int)nthreads < 1)
+			nthreads = 1;
+	}
+
+	/* Random code hits undocumented opcodes and stack wrap-around all the
+	 * time, the library warns about each of them */
+	if (!verbose) {
+		fd = open("/dev/null", O_WRONLY);
+		if (fd >= 0) {
+			dup2(fd, STDERR_FILENO);
+			close(fd);
+		}
+	}
+
+	threads = malloc(nthreads * sizeof(*threads));
+	if (threads == NULL)
+		return 1;
+
+	printf("%s vs %s: %lu cases, %lu programs of %lu steps, %u threads\n",
+		ref->name, cand->name, ncases, nprograms, length, nthreads);
+	fflush(stdout);
+
+	for (i = 0; i < nthreads; ++i)
+		pthread_create(&threads[i], NULL, worker, NULL);
+
+	for (i = 0; i < nthreads; ++i)
+		pthread_join(threads[i], NULL);
+
+	free(threads);
+
+	if (dump != NULL)
+		fclose(dump);
+
+	if (failed)
+		return 1;
+
+	printf("PASS\n");
+
+	return 0;
+}
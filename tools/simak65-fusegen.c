@@ -0,0 +1,340 @@
+/* SimAK65 superinstruction generator
+ * Copyright A.K. 2026
+ *
+ * Reads an opcode sequence profile written by simak65-seq and generates
+ * fused handlers for the most frequent sequences, included by exec.c.
+ * Runs at build time, so it's built with the decoder only.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include "decoder.h"
+#include "flags.h"
+
+#define FUSE_LEN 3
+
+struct fuse_seq {
+	unsigned long long count;
+	u8 ops[FUSE_LEN];
+	unsigned int len;
+};
+
+/* Sequence trie, children of the root are the first opcodes */
+struct fuse_node {
+	u8 op;
+	struct fuse_node *child;
+	struct fuse_node *sibling;
+};
+
+static const char *fuse_mode[] = {
+	"modeAcc", "modeAbsolute", "modeAbsoluteX", "modeAbsoluteY",
+	"modeImmediate", "modeImplicant", "modeIndirect", "modeIndirectX",
+	"modeIndirectY", "modeRelative", "modeZeropage", "modeZeropageX",
+	"modeZeropageY"
+};
+
+static int fuse_cmp(const void *a, const void *b)
+{
+	const struct fuse_seq *x = a, *y = b;
+	unsigned long long sx = x->count * (x->len - 1), sy = y->count * (y->len - 1);
+
+	return (sx < sy) - (sx > sy);
+}
+
+static int fuse_valid(u8 op)
+{
+	return decode(op).opcode != NOP || op == 0xea;
+}
+
+/* Instructions that may run native code or start a recording in the
+ * handler, only ever end a sequence */
+static int fuse_terminal(u8 op)
+{
+	switch (decode(op).opcode) {
+		case JSR:
+		case RTS:
+		case RTI:
+		case BRK:
+		case BNE:
+			return 1;
+
+		default:
+			return 0;
+	}
+}
+
+/* Register holding the result N and Z are set from, NULL if the flags
+ * can't be deferred */
+static const char *fuse_result(u8 op)
+{
+	switch (decode(op).opcode) {
+		case AND:
+		case EOR:
+		case ORA:
+		case LDA:
+		case TXA:
+		case TYA:
+			return "a";
+
+		case LDX:
+		case TAX:
+		case TSX:
+		case DEX:
+		case INX:
+			return "x";
+
+		case LDY:
+		case TAY:
+		case DEY:
+		case INY:
+			return "y";
+
+		default:
+			return NULL;
+	}
+}
+
+/* Tells whether N and Z set by op are set again by next before being read */
+static int fuse_nzdead(u8 op, u8 next)
+{
+	u8 ops[2] = { op, next }, dead[2];
+
+	decode_deadflags(ops, 2, dead);
+
+	return (dead[0] & (FLAG_SIGN | FLAG_ZERO)) == (FLAG_SIGN | FLAG_ZERO);
+}
+
+static struct fuse_node *fuse_insert(struct fuse_node *parent, u8 op)
+{
+	struct fuse_node *node;
+
+	for (node = parent->child; node != NULL; node = node->sibling) {
+		if (node->op == op)
+			return node;
+	}
+
+	node = calloc(1, sizeof(*node));
+	if (node == NULL) {
+		fprintf(stderr, "Out of memory\n");
+		exit(1);
+	}
+
+	node->op = op;
+	node->sibling = parent->child;
+	parent->child = node;
+
+	return node;
+}
+
+static void fuse_indent(FILE *f, unsigned int depth)
+{
+	while (depth-- > 0)
+		fputc('\t', f);
+}
+
+static void fuse_name(char *buf, u8 op)
+{
+	const char *s = opcodetostring(decode(op).opcode);
+	unsigned int i;
+
+	for (i = 0; s[i] != '\0'; ++i)
+		buf[i] = tolower((unsigned char)s[i]);
+	buf[i] = '\0';
+}
+
+/* Execute node and continue with its children, depth is the indentation.
+ * N and Z of a node are set only on the paths where they are observed. */
+static void fuse_emit(FILE *f, const struct fuse_node *node, unsigned int depth)
+{
+	const char *result = fuse_result(node->op), *defer = NULL;
+	const struct fuse_node *c;
+	char name[8];
+
+	fuse_name(name, node->op);
+
+	for (c = node->child; c != NULL && result != NULL; c = c->sibling) {
+		if (fuse_nzdead(node->op, c->op))
+			defer = result;
+	}
+
+	fuse_indent(f, depth);
+	fprintf(f, "argtype = %s(cpu, args);\n", fuse_mode[decode(node->op).mode]);
+	fuse_indent(f, depth);
+	fprintf(f, "PERF_INC(cpu, instructions);\n");
+	fuse_indent(f, depth);
+	fprintf(f, "exec_%s%s(cpu, argtype, args);\n", name, (defer != NULL) ? "_nz" : "");
+
+	if (node->child == NULL) {
+		fprintf(f, "\n");
+		fuse_indent(f, depth);
+		fprintf(f, "return -1;\n");
+		return;
+	}
+
+	fprintf(f, "\n");
+	fuse_indent(f, depth);
+	fprintf(f, "opcode = addrmode_nextpc(cpu);\n");
+	fuse_indent(f, depth);
+	fprintf(f, "switch (opcode) {\n");
+
+	for (c = node->child; c != NULL; c = c->sibling) {
+		fuse_indent(f, depth + 1);
+		fprintf(f, "case 0x%02x:\n", c->op);
+		if (defer != NULL && !fuse_nzdead(node->op, c->op)) {
+			fuse_indent(f, depth + 2);
+			fprintf(f, "exec_nz(cpu, cpu->reg.%s);\n", defer);
+		}
+		fuse_emit(f, c, depth + 2);
+	}
+
+	fuse_indent(f, depth);
+	fprintf(f, "}\n\n");
+	if (defer != NULL) {
+		fuse_indent(f, depth);
+		fprintf(f, "exec_nz(cpu, cpu->reg.%s);\n", defer);
+	}
+	fuse_indent(f, depth);
+	fprintf(f, "return opcode;\n");
+}
+
+static void fuse_comment(FILE *f, const struct fuse_node *node, char *prefix, size_t len)
+{
+	const struct fuse_node *c;
+	char name[8];
+	size_t n;
+
+	fuse_name(name, node->op);
+	n = len + sprintf(prefix + len, "%s%s", len ? " " : "", name);
+
+	if (node->child == NULL)
+		fprintf(f, " *   %s\n", prefix);
+
+	for (c = node->child; c != NULL; c = c->sibling)
+		fuse_comment(f, c, prefix, n);
+
+	prefix[len] = '\0';
+}
+
+static int fuse_generate(FILE *f, const char *profile, const struct fuse_node *root)
+{
+	const struct fuse_node *node;
+	char prefix[64];
+
+	fprintf(f, "/* SimAK65 fused instruction handlers\n");
+	fprintf(f, " * Generated by simak65-fusegen from %s, do not edit\n */\n", profile);
+
+	for (node = root->child; node != NULL; node = node->sibling) {
+		prefix[0] = '\0';
+		fprintf(f, "\n/* Sequences starting with 0x%02x:\n", node->op);
+		fuse_comment(f, node, prefix, 0);
+		fprintf(f, " */\n");
+		fprintf(f, "static int fuse_%02x(struct simak65_cpu *cpu)\n{\n", node->op);
+		fprintf(f, "\tenum argtype argtype;\n\tu8 args[2];\n\tu8 opcode;\n\n");
+		fuse_emit(f, node, 1);
+		fprintf(f, "}\n");
+	}
+
+	fprintf(f, "\nconst exec_fuse_t exec_fuse[256] = {\n");
+	for (node = root->child; node != NULL; node = node->sibling)
+		fprintf(f, "\t[0x%02x] = fuse_%02x,\n", node->op, node->op);
+	fprintf(f, "};\n");
+
+	return ferror(f) ? -1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+	struct fuse_seq *seqs = NULL, *tmp;
+	struct fuse_node root = { 0 }, *node;
+	unsigned int max = 32, n = 0, size = 0, i, k;
+	unsigned int ops[FUSE_LEN];
+	char line[256];
+	FILE *f;
+	int opt, len;
+
+	while ((opt = getopt(argc, argv, "n:h")) != -1) {
+		switch (opt) {
+			case 'n':
+				max = strtoul(optarg, NULL, 0);
+				break;
+
+			default:
+				fprintf(stderr, "Usage: %s [-n sequences] profile output\n", argv[0]);
+				return (opt == 'h') ? 0 : 1;
+		}
+	}
+
+	if (argc - optind != 2) {
+		fprintf(stderr, "Usage: %s [-n sequences] profile output\n", argv[0]);
+		return 1;
+	}
+
+	f = fopen(argv[optind], "r");
+	if (f == NULL) {
+		perror(argv[optind]);
+		return 1;
+	}
+
+	while (fgets(line, sizeof(line), f) != NULL) {
+		if (line[0] == '#' || line[0] == '\n')
+			continue;
+
+		if (n == size) {
+			size = size ? 2 * size : 256;
+			tmp = realloc(seqs, size * sizeof(*seqs));
+			if (tmp == NULL) {
+				fprintf(stderr, "Out of memory\n");
+				return 1;
+			}
+			seqs = tmp;
+		}
+
+		len = sscanf(line, "%llu %x %x %x", &seqs[n].count, &ops[0], &ops[1], &ops[2]) - 1;
+		if (len < 2) {
+			fprintf(stderr, "%s: invalid line %s", argv[optind], line);
+			return 1;
+		}
+
+		seqs[n].len = len;
+		for (k = 0; k < seqs[n].len; ++k) {
+			if (ops[k] > 0xff || !fuse_valid(ops[k]))
+				break;
+			seqs[n].ops[k] = ops[k];
+
+			if (fuse_terminal(ops[k]))
+				seqs[n].len = k + 1;
+		}
+
+		/* Invalid opcodes are left to the interpreter */
+		if (k == seqs[n].len && seqs[n].len > 1)
+			++n;
+	}
+
+	fclose(f);
+
+	qsort(seqs, n, sizeof(*seqs), fuse_cmp);
+
+	for (i = 0; i < n && i < max; ++i) {
+		for (node = &root, k = 0; k < seqs[i].len; ++k)
+			node = fuse_insert(node, seqs[i].ops[k]);
+	}
+
+	f = fopen(argv[optind + 1], "w");
+	if (f == NULL) {
+		perror(argv[optind + 1]);
+		return 1;
+	}
+
+	if (fuse_generate(f, argv[optind], &root) < 0 || fclose(f) != 0) {
+		fprintf(stderr, "Could not write %s\n", argv[optind + 1]);
+		remove(argv[optind + 1]);
+		return 1;
+	}
+
+	free(seqs);
+
+	return 0;
+}
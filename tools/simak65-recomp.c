@@ -0,0 +1,337 @@
+/* SimAK65 ahead-of-time recompiler
+ * Copyright A.K. 2026
+ *
+ * Walks the control flow of a ROM image from the reset, IRQ and NMI
+ * vectors and generates C source with a function per basic block. The
+ * blocks execute through the same inline handlers as the interpreter, so
+ * bus accesses, cycles and counters stay exact. Built with the decoder
+ * only, the output is compiled against the library sources.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include "decoder.h"
+#include "flags.h"
+#include "aot.h"
+
+#define VECTOR_NMI 0xfffa
+#define VECTOR_RST 0xfffc
+#define VECTOR_IRQ 0xfffe
+
+/* Address marks */
+#define RECOMP_LEADER  0x01
+#define RECOMP_VISITED 0x02
+
+static u8 image[0x10000];
+static u32 base, size;
+static u8 marks[0x10000];
+static u16 work[0x10000];
+static unsigned int nwork;
+
+static const char *recomp_mode[] = {
+	"modeAcc", "modeAbsolute", "modeAbsoluteX", "modeAbsoluteY",
+	"modeImmediate", "modeImplicant", "modeIndirect", "modeIndirectX",
+	"modeIndirectY", "modeRelative", "modeZeropage", "modeZeropageX",
+	"modeZeropageY"
+};
+
+/* Tells whether the whole instruction at addr is in the image */
+static int recomp_inside(u32 addr)
+{
+	u8 op;
+
+	if (addr < base || addr >= base + size)
+		return 0;
+
+	op = image[addr - base];
+	if (decode(op).opcode == NOP && op != 0xea)
+		return 0;
+
+	return (addr + decode_length(op) <= base + size);
+}
+
+static u8 recomp_byte(u16 addr)
+{
+	return image[addr - base];
+}
+
+static void recomp_leader(u32 addr)
+{
+	if (!recomp_inside(addr) || (marks[addr] & RECOMP_LEADER))
+		return;
+
+	marks[addr] |= RECOMP_LEADER;
+	work[nwork++] = addr;
+}
+
+static void recomp_vector(u32 vector)
+{
+	if (vector >= base && vector + 1 < base + size)
+		recomp_leader(recomp_byte(vector) | ((u16)recomp_byte(vector + 1) << 8));
+}
+
+/* Tells whether the instruction ends a block, adds its successors */
+static int recomp_successors(u16 addr)
+{
+	u8 op = recomp_byte(addr);
+	u16 next = addr + decode_length(op), target;
+
+	switch (decode(op).opcode) {
+		case BCC:
+		case BCS:
+		case BEQ:
+		case BMI:
+		case BNE:
+		case BPL:
+		case BVC:
+		case BVS:
+			recomp_leader((u16)(next + (s8)recomp_byte(addr + 1)));
+			recomp_leader(next);
+			return 1;
+
+		case JSR:
+			recomp_leader(next);
+			/* fall-through */
+		case JMP:
+			target = recomp_byte(addr + 1) | ((u16)recomp_byte(addr + 2) << 8);
+			if (decode(op).mode == mode_abs)
+				recomp_leader(target);
+			return 1;
+
+		case BRK:
+		case RTI:
+		case RTS:
+			return 1;
+
+		default:
+			return 0;
+	}
+}
+
+/* Mark every leader reachable from the vectors */
+static void recomp_walk(void)
+{
+	u16 addr;
+
+	recomp_vector(VECTOR_RST);
+	recomp_vector(VECTOR_IRQ);
+	recomp_vector(VECTOR_NMI);
+
+	while (nwork > 0) {
+		addr = work[--nwork];
+
+		while (!(marks[addr] & RECOMP_VISITED)) {
+			marks[addr] |= RECOMP_VISITED;
+
+			if (recomp_successors(addr))
+				break;
+
+			addr += decode_length(recomp_byte(addr));
+			if (!recomp_inside(addr))
+				break;
+		}
+	}
+}
+
+static void recomp_name(char *buf, u8 op)
+{
+	const char *s = opcodetostring(decode(op).opcode);
+	unsigned int i;
+
+	for (i = 0; s[i] != '\0'; ++i)
+		buf[i] = tolower((unsigned char)s[i]);
+	buf[i] = '\0';
+}
+
+/* Tells whether N and Z of the instruction can be skipped, see fusegen */
+static int recomp_nzonly(u8 op)
+{
+	switch (decode(op).opcode) {
+		case AND:
+		case EOR:
+		case ORA:
+		case LDA:
+		case LDX:
+		case LDY:
+		case TAX:
+		case TAY:
+		case TSX:
+		case TXA:
+		case TYA:
+		case DEX:
+		case DEY:
+		case INX:
+		case INY:
+			return 1;
+
+		default:
+			return 0;
+	}
+}
+
+/* Emit the block at addr, returns the number of instructions */
+static unsigned int recomp_block(FILE *f, u16 addr)
+{
+	u8 ops[AOT_INSNS], dead[AOT_INSNS], bytes[3];
+	u16 pcs[AOT_INSNS];
+	unsigned int n = 0, i, k;
+	char name[8], text[32];
+
+	/* Straight-line run up to a control transfer or the next leader */
+	for (;;) {
+		pcs[n] = addr;
+		ops[n++] = recomp_byte(addr);
+
+		if (recomp_successors(addr))
+			break;
+
+		addr += decode_length(ops[n - 1]);
+
+		if (!recomp_inside(addr))
+			break;
+
+		if (n == AOT_INSNS) {
+			marks[addr] |= RECOMP_LEADER;
+			break;
+		}
+
+		if (marks[addr] & RECOMP_LEADER)
+			break;
+	}
+
+	/* All instructions of a block run, so a flag set again before being
+	 * read is never observed */
+	decode_deadflags(ops, n, dead);
+
+	fprintf(f, "\nstatic void block_%04x(struct simak65_cpu *cpu)\n{\n", pcs[0]);
+	fprintf(f, "\tenum argtype argtype;\n\tu8 args[2];\n");
+
+	for (i = 0; i < n; ++i) {
+		for (k = 0; k < decode_length(ops[i]); ++k)
+			bytes[k] = recomp_byte(pcs[i] + k);
+		decode_disasm(text, sizeof(text), pcs[i], bytes);
+		recomp_name(name, ops[i]);
+
+		fprintf(f, "\n\t/* %04x: %s */\n", pcs[i], text);
+		fprintf(f, "\taddrmode_nextpc(cpu);\n");
+		fprintf(f, "\targtype = %s(cpu, args);\n", recomp_mode[decode(ops[i]).mode]);
+		fprintf(f, "\tPERF_INC(cpu, instructions);\n");
+		fprintf(f, "\texec_%s%s(cpu, argtype, args);\n", name,
+			(recomp_nzonly(ops[i]) && (dead[i] & (FLAG_SIGN | FLAG_ZERO)) == (FLAG_SIGN | FLAG_ZERO)) ? "_nz" : "");
+	}
+
+	fprintf(f, "}\n");
+
+	return n;
+}
+
+static int recomp_generate(FILE *f, const char *path, const char *name)
+{
+	unsigned int blocks = 0, insns = 0;
+	u32 addr, i;
+
+	fprintf(f, "/* SimAK65 recompiled image\n");
+	fprintf(f, " * Generated by simak65-recomp from %s, do not edit\n */\n\n", path);
+	fprintf(f, "#include \"insn.h\"\n");
+
+	/* Leaders added by splitting long blocks are always further on */
+	for (addr = base; addr < base + size; ++addr) {
+		if (marks[addr] & RECOMP_LEADER) {
+			insns += recomp_block(f, addr);
+			++blocks;
+		}
+	}
+
+	fprintf(f, "\nstatic const simak65_block_fn blocks[0x%x] = {\n", size);
+	for (addr = base; addr < base + size; ++addr) {
+		if (marks[addr] & RECOMP_LEADER)
+			fprintf(f, "\t[0x%04x] = block_%04x,\n", addr - base, addr);
+	}
+	fprintf(f, "};\n");
+
+	fprintf(f, "\nstatic const u8 image[0x%x] = {", size);
+	for (i = 0; i < size; ++i)
+		fprintf(f, "%s0x%02x,", (i % 16) ? " " : "\n\t", image[i]);
+	fprintf(f, "\n};\n");
+
+	fprintf(f, "\nconst struct simak65_aot %s = { 0x%04x, 0x%x, image, blocks };\n", name, base, size);
+
+	fprintf(stderr, "%u blocks, %u instructions\n", blocks, insns);
+
+	return ferror(f) ? -1 : 0;
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr, "Usage: %s [-b base] [-s symbol] image output\n", prog);
+	fprintf(stderr, "  -b  load address, the image ends at 0xffff by default\n");
+	fprintf(stderr, "  -s  name of the struct simak65_aot defined (simak65_rom)\n");
+}
+
+int main(int argc, char *argv[])
+{
+	const char *name = "simak65_rom";
+	long start = -1;
+	FILE *f;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "b:s:h")) != -1) {
+		switch (opt) {
+			case 'b':
+				start = strtol(optarg, NULL, 0);
+				break;
+
+			case 's':
+				name = optarg;
+				break;
+
+			default:
+				usage(argv[0]);
+				return (opt == 'h') ? 0 : 1;
+		}
+	}
+
+	if (argc - optind != 2) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	f = fopen(argv[optind], "rb");
+	if (f == NULL) {
+		perror(argv[optind]);
+		return 1;
+	}
+
+	size = fread(image, 1, sizeof(image), f);
+	fclose(f);
+
+	if (size == 0) {
+		fprintf(stderr, "%s: empty image\n", argv[optind]);
+		return 1;
+	}
+
+	base = (start < 0) ? 0x10000 - size : (u32)start;
+	if (base + size > 0x10000) {
+		fprintf(stderr, "%s: image does not fit at 0x%04x\n", argv[optind], base);
+		return 1;
+	}
+
+	recomp_walk();
+
+	f = fopen(argv[optind + 1], "w");
+	if (f == NULL) {
+		perror(argv[optind + 1]);
+		return 1;
+	}
+
+	if (recomp_generate(f, argv[optind], name) < 0 || fclose(f) != 0) {
+		fprintf(stderr, "Could not write %s\n", argv[optind + 1]);
+		remove(argv[optind + 1]);
+		return 1;
+	}
+
+	return 0;
+}
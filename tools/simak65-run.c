@@ -0,0 +1,474 @@
+/* SimAK65 headless runner
+ * Copyright A.K. 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <simak65.h>
+
+#define JOB_MAX_ITEMS 16
+#define JOB_MAX_ARGS 128
+
+struct image {
+	const char *path;
+	uint16_t addr;
+};
+
+struct region {
+	uint16_t start;
+	uint16_t end;
+	/* Written as binary if set, hex dump to the output otherwise */
+	const char *path;
+};
+
+struct job {
+	struct image images[JOB_MAX_ITEMS];
+	unsigned int nimages;
+	struct region regions[JOB_MAX_ITEMS];
+	unsigned int nregions;
+	uint16_t traps[JOB_MAX_ITEMS];
+	unsigned int ntraps;
+
+	int start;
+	uint16_t pc;
+	unsigned long cycles;
+	unsigned long insns;
+	int brk;
+	int perf;
+
+	/* Output, printed in job order once all are done */
+	char *out;
+	size_t outsize;
+	int result;
+};
+
+static __thread uint8_t *mem;
+
+static uint8_t run_read(uint16_t addr)
+{
+	return mem[addr];
+}
+
+static void run_write(uint16_t addr, uint8_t data)
+{
+	mem[addr] = data;
+}
+
+static struct job *jobs;
+static unsigned int njobs, next_job;
+
+static void usage(const char *prog)
+{
+	fprintf(stderr, "Usage: %s [options]\n", prog);
+	fprintf(stderr, "  -l file@addr     load an image, addresses are hex\n");
+	fprintf(stderr, "  -s addr          start at addr instead of the reset vector\n");
+	fprintf(stderr, "  -c cycles        stop after the number of cycles\n");
+	fprintf(stderr, "  -i instructions  stop after the number of instructions\n");
+	fprintf(stderr, "  -b               stop before executing BRK\n");
+	fprintf(stderr, "  -t addr          stop when reaching addr\n");
+	fprintf(stderr, "  -d start:end[@file]  dump memory, inclusive range\n");
+	fprintf(stderr, "  -p               print performance counters\n");
+	fprintf(stderr, "  -j file          run the jobs listed in file, one option list per line\n");
+	fprintf(stderr, "  -J threads       jobs run in parallel, 0 for one per core\n");
+}
+
+static int parse_addr(const char *s, uint16_t *addr)
+{
+	char *end;
+	unsigned long v;
+
+	v = strtoul(s, &end, 16);
+	if (end == s || v > 0xffff)
+		return -1;
+
+	*addr = v;
+
+	return end - s;
+}
+
+/* Parse job options, returns -1 on error */
+static int job_parse(struct job *job, int argc, char *argv[], const char **jobfile, unsigned int *threads)
+{
+	const char *at;
+	int opt, n;
+
+	memset(job, 0, sizeof(*job));
+
+	/* Full reinitialisation, options are parsed once per job */
+	optind = 0;
+
+	while ((opt = getopt(argc, argv, "l:s:c:i:bt:d:pj:J:h")) != -1) {
+		switch (opt) {
+			case 'l':
+				at = strrchr(optarg, '@');
+				if (at == NULL || job->nimages == JOB_MAX_ITEMS || parse_addr(at + 1, &job->images[job->nimages].addr) < 0) {
+					fprintf(stderr, "Invalid image %s\n", optarg);
+					return -1;
+				}
+				job->images[job->nimages++].path = strndup(optarg, at - optarg);
+				break;
+
+			case 's':
+				if (parse_addr(optarg, &job->pc) < 0) {
+					fprintf(stderr, "Invalid start %s\n", optarg);
+					return -1;
+				}
+				job->start = 1;
+				break;
+
+			case 'c':
+				job->cycles = strtoul(optarg, NULL, 0);
+				break;
+
+			case 'i':
+				job->insns = strtoul(optarg, NULL, 0);
+				break;
+
+			case 'b':
+				job->brk = 1;
+				break;
+
+			case 't':
+				if (job->ntraps == JOB_MAX_ITEMS || parse_addr(optarg, &job->traps[job->ntraps]) < 0) {
+					fprintf(stderr, "Invalid trap %s\n", optarg);
+					return -1;
+				}
+				job->ntraps++;
+				break;
+
+			case 'd':
+				if (job->nregions == JOB_MAX_ITEMS || (n = parse_addr(optarg, &job->regions[job->nregions].start)) < 0 ||
+						optarg[n] != ':' || (n = parse_addr(at = optarg + n + 1, &job->regions[job->nregions].end)) < 0 ||
+						(at[n] != '\0' && at[n] != '@') || job->regions[job->nregions].end < job->regions[job->nregions].start) {
+					fprintf(stderr, "Invalid region %s\n", optarg);
+					return -1;
+				}
+				job->regions[job->nregions++].path = (at[n] == '@') ? at + n + 1 : NULL;
+				break;
+
+			case 'p':
+				job->perf = 1;
+				break;
+
+			case 'j':
+			case 'J':
+				if (jobfile == NULL) {
+					fprintf(stderr, "-%c in a job list\n", opt);
+					return -1;
+				}
+				if (opt == 'j')
+					*jobfile = optarg;
+				else
+					*threads = strtoul(optarg, NULL, 0);
+				break;
+
+			default:
+				return -1;
+		}
+	}
+
+	if (optind != argc) {
+		fprintf(stderr, "Unexpected argument %s\n", argv[optind]);
+		return -1;
+	}
+
+	if ((jobfile == NULL || *jobfile == NULL) && job->cycles == 0 && job->insns == 0 && !job->brk && job->ntraps == 0) {
+		fprintf(stderr, "No stop condition given\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+static int job_load(const struct job *job, FILE *out)
+{
+	unsigned int i;
+	size_t len;
+	FILE *f;
+
+	for (i = 0; i < job->nimages; ++i) {
+		f = fopen(job->images[i].path, "rb");
+		if (f == NULL) {
+			fprintf(out, "error: could not open %s\n", job->images[i].path);
+			return -1;
+		}
+
+		len = fread(mem + job->images[i].addr, 1, 0x10000 - job->images[i].addr, f);
+		fclose(f);
+
+		if (len == 0) {
+			fprintf(out, "error: %s is empty\n", job->images[i].path);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int job_dump(const struct job *job, FILE *out)
+{
+	const struct region *r;
+	unsigned int i, addr;
+	size_t len;
+	FILE *f;
+
+	for (i = 0; i < job->nregions; ++i) {
+		r = &job->regions[i];
+		len = (size_t)r->end - r->start + 1;
+
+		if (r->path != NULL) {
+			f = fopen(r->path, "wb");
+			if (f == NULL || fwrite(mem + r->start, 1, len, f) != len) {
+				fprintf(out, "error: could not write %s\n", r->path);
+				if (f != NULL)
+					fclose(f);
+				return -1;
+			}
+			fclose(f);
+			continue;
+		}
+
+		for (addr = r->start; addr <= r->end; ++addr) {
+			if (addr == r->start || (addr & 0xf) == 0)
+				fprintf(out, "%s%04x:", (addr == r->start) ? "" : "\n", addr);
+			fprintf(out, " %02x", mem[addr]);
+		}
+		fprintf(out, "\n");
+	}
+
+	return 0;
+}
+
+static void job_run(struct job *job)
+{
+	struct simak65_cpu cpu;
+	struct simak65_perf perf;
+	const char *stop = "cycles";
+	unsigned long n = 0;
+	unsigned int i;
+	FILE *out;
+
+	out = open_memstream(&job->out, &job->outsize);
+	if (out == NULL) {
+		job->result = -1;
+		return;
+	}
+
+	memset(mem, 0, 0x10000);
+	job->result = job_load(job, out);
+	if (job->result < 0) {
+		fclose(out);
+		return;
+	}
+
+	cpu.bus.read = run_read;
+	cpu.bus.write = run_write;
+	simak65_init(&cpu);
+	simak65_rst(&cpu);
+
+	if (job->start)
+		cpu.reg.pc = job->pc;
+
+	for (i = 0; i < job->ntraps; ++i)
+		simak65_break_set(&cpu, job->traps[i]);
+
+	simak65_perf_reset(&cpu);
+
+	if (job->brk || job->insns != 0) {
+		/* Stepping, BRK and the instruction limit need a look at every
+		 * instruction */
+		for (;;) {
+			if (job->insns != 0 && n >= job->insns) {
+				stop = "instructions";
+				break;
+			}
+
+			if (job->cycles != 0 && cpu.cycles >= job->cycles) {
+				stop = "cycles";
+				break;
+			}
+
+			if (job->brk && mem[cpu.reg.pc] == 0x00) {
+				stop = "brk";
+				break;
+			}
+
+			if (job->ntraps != 0 && simak65_break_hit(&cpu) && n != 0) {
+				stop = "trap";
+				break;
+			}
+
+			simak65_step(&cpu);
+			++n;
+		}
+	}
+	else {
+		do {
+			if (simak65_run(&cpu, (job->cycles != 0) ? job->cycles - cpu.cycles : 1UL << 30) == simak65_stop_break) {
+				stop = "trap";
+				break;
+			}
+		} while (job->cycles == 0 || cpu.cycles < job->cycles);
+	}
+
+	simak65_break_clear_all(&cpu);
+	simak65_perf_read(&cpu, &perf);
+
+	fprintf(out, "stop=%s pc=%04x a=%02x x=%02x y=%02x sp=%02x p=%02x cycles=%lu instructions=%llu\n",
+		stop, cpu.reg.pc, cpu.reg.a, cpu.reg.x, cpu.reg.y, cpu.reg.sp, cpu.reg.flags, cpu.cycles,
+		(unsigned long long)((perf.instructions != 0) ? perf.instructions : n));
+
+	if (job->perf) {
+		fprintf(out, "perf fetches=%llu reads=%llu writes=%llu stack_reads=%llu stack_writes=%llu "
+			"branches_taken=%llu branches_not_taken=%llu interrupts=%llu invalid=%llu decimal=%llu\n",
+			(unsigned long long)perf.fetches, (unsigned long long)perf.reads, (unsigned long long)perf.writes,
+			(unsigned long long)perf.stack_reads, (unsigned long long)perf.stack_writes,
+			(unsigned long long)perf.branches_taken, (unsigned long long)perf.branches_not_taken,
+			(unsigned long long)perf.interrupts, (unsigned long long)perf.invalid, (unsigned long long)perf.decimal);
+	}
+
+	job->result = job_dump(job, out);
+	fclose(out);
+}
+
+static void *worker(void *arg)
+{
+	unsigned int i;
+
+	(void)arg;
+
+	mem = malloc(0x10000);
+	if (mem == NULL)
+		return NULL;
+
+	while ((i = __atomic_fetch_add(&next_job, 1, __ATOMIC_RELAXED)) < njobs)
+		job_run(&jobs[i]);
+
+	free(mem);
+
+	return NULL;
+}
+
+/* Split a job list line into arguments, no quoting */
+static int job_split(char *line, char *argv[])
+{
+	int argc = 1;
+	char *tok;
+
+	argv[0] = "job";
+
+	for (tok = strtok(line, " \t\r\n"); tok != NULL && argc < JOB_MAX_ARGS - 1; tok = strtok(NULL, " \t\r\n"))
+		argv[argc++] = tok;
+
+	argv[argc] = NULL;
+
+	return argc;
+}
+
+static int jobs_read(const char *path)
+{
+	char line[4096], *argv[JOB_MAX_ARGS];
+	unsigned int lineno = 0;
+	struct job *tmp;
+	int argc, i;
+	FILE *f;
+
+	f = fopen(path, "r");
+	if (f == NULL) {
+		perror(path);
+		return -1;
+	}
+
+	while (fgets(line, sizeof(line), f) != NULL) {
+		++lineno;
+		argc = job_split(line, argv);
+		if (argc == 1 || argv[1][0] == '#')
+			continue;
+
+		tmp = realloc(jobs, (njobs + 1) * sizeof(*jobs));
+		if (tmp == NULL) {
+			fclose(f);
+			return -1;
+		}
+		jobs = tmp;
+
+		/* Arguments point into line, keep a copy per job */
+		for (i = 1; i < argc; ++i)
+			argv[i] = strdup(argv[i]);
+
+		if (job_parse(&jobs[njobs], argc, argv, NULL, NULL) < 0) {
+			fprintf(stderr, "%s:%u: invalid job\n", path, lineno);
+			fclose(f);
+			return -1;
+		}
+		++njobs;
+	}
+
+	fclose(f);
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *jobfile = NULL;
+	unsigned int threads = 0, i;
+	pthread_t *tids;
+	struct job single;
+	int err = 0;
+
+	if (argc < 2 || job_parse(&single, argc, argv, &jobfile, &threads) < 0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	if (jobfile != NULL) {
+		if (jobs_read(jobfile) < 0)
+			return 1;
+	}
+	else {
+		jobs = &single;
+		njobs = 1;
+		threads = 1;
+	}
+
+	if (threads == 0) {
+		threads = sysconf(_SC_NPROCESSORS_ONLN);
+		if ((int)threads < 1)
+			threads = 1;
+	}
+	if (threads > njobs)
+		threads = (njobs != 0) ? njobs : 1;
+
+	tids = malloc(threads * sizeof(*tids));
+	if (tids == NULL)
+		return 1;
+
+	for (i = 0; i < threads; ++i)
+		pthread_create(&tids[i], NULL, worker, NULL);
+
+	for (i = 0; i < threads; ++i)
+		pthread_join(tids[i], NULL);
+
+	free(tids);
+
+	for (i = 0; i < njobs; ++i) {
+		if (jobfile != NULL)
+			printf("job %u ", i + 1);
+
+		if (jobs[i].out != NULL)
+			fwrite(jobs[i].out, 1, jobs[i].outsize, stdout);
+		else
+			printf("error: out of memory\n");
+
+		if (jobs[i].out == NULL || jobs[i].result < 0)
+			err = 1;
+
+		free(jobs[i].out);
+	}
+
+	return err;
+}
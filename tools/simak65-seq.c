@@ -0,0 +1,126 @@
+/* SimAK65 opcode sequence profile
+ * Copyright A.K. 2026
+ *
+ * Counts the opcode pairs and triples executed in instruction trace files
+ * and prints the most frequent ones, the input of simak65-fusegen.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <simak65.h>
+
+struct seq {
+	uint64_t count;
+	uint32_t key;
+	unsigned int len;
+};
+
+static int seq_cmp(const void *a, const void *b)
+{
+	const struct seq *x = a, *y = b;
+
+	if (x->count != y->count)
+		return (x->count < y->count) ? 1 : -1;
+
+	return (x->key > y->key) - (x->key < y->key);
+}
+
+int main(int argc, char *argv[])
+{
+	struct simak65_trace_rec rec;
+	struct simak65_tracemap *tm;
+	uint64_t *pairs, *triples, total = 0;
+	struct seq *seqs;
+	unsigned int lines = 64, n = 0, i, k;
+	uint32_t window;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "n:h")) != -1) {
+		switch (opt) {
+			case 'n':
+				lines = strtoul(optarg, NULL, 0);
+				break;
+
+			default:
+				fprintf(stderr, "Usage: %s [-n lines] trace...\n", argv[0]);
+				return (opt == 'h') ? 0 : 1;
+		}
+	}
+
+	if (optind == argc) {
+		fprintf(stderr, "No trace given\n");
+		return 1;
+	}
+
+	pairs = calloc(1 << 16, sizeof(*pairs));
+	triples = calloc(1 << 24, sizeof(*triples));
+	if (pairs == NULL || triples == NULL) {
+		fprintf(stderr, "Out of memory\n");
+		return 1;
+	}
+
+	for (; optind < argc; ++optind) {
+		tm = simak65_tracemap_open(argv[optind]);
+		if (tm == NULL) {
+			fprintf(stderr, "Could not open %s\n", argv[optind]);
+			return 1;
+		}
+
+		/* Sequences don't span files */
+		for (window = 0, k = 0; simak65_tracemap_next(tm, &rec) == 0; ++total) {
+			window = ((window << 8) | rec.opcode) & 0xffffff;
+			if (++k >= 2)
+				pairs[window & 0xffff]++;
+			if (k >= 3)
+				triples[window]++;
+		}
+
+		simak65_tracemap_close(tm);
+	}
+
+	for (i = 0; i < (1 << 16); ++i)
+		n += (pairs[i] != 0);
+	for (i = 0; i < (1 << 24); ++i)
+		n += (triples[i] != 0);
+
+	seqs = malloc((n + 1) * sizeof(*seqs));
+	if (seqs == NULL) {
+		fprintf(stderr, "Out of memory\n");
+		return 1;
+	}
+
+	for (i = 0, n = 0; i < (1 << 16); ++i) {
+		if (pairs[i] != 0) {
+			seqs[n].count = pairs[i];
+			seqs[n].key = i;
+			seqs[n++].len = 2;
+		}
+	}
+
+	for (i = 0; i < (1 << 24); ++i) {
+		if (triples[i] != 0) {
+			seqs[n].count = triples[i];
+			seqs[n].key = i;
+			seqs[n++].len = 3;
+		}
+	}
+
+	qsort(seqs, n, sizeof(*seqs), seq_cmp);
+
+	printf("# %llu instructions\n", (unsigned long long)total);
+
+	for (i = 0; i < n && i < lines; ++i) {
+		printf("%llu", (unsigned long long)seqs[i].count);
+		for (k = seqs[i].len; k > 0; --k)
+			printf(" %02x", (seqs[i].key >> (8 * (k - 1))) & 0xff);
+		printf("\n");
+	}
+
+	free(seqs);
+	free(pairs);
+	free(triples);
+
+	return 0;
+}
@@ -0,0 +1,156 @@
+/* SimAK65 live metrics viewer
+ * Copyright A.K. 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <simak65.h>
+
+#define MAX_INSTANCES 64
+
+struct instance {
+	char name[256];
+	struct simak65_metrics *m;
+	struct simak65_metrics_sample last;
+	int valid;
+};
+
+static const char *stop_name(enum simak65_stop stop)
+{
+	switch (stop) {
+		case simak65_stop_none: return "running";
+		case simak65_stop_cycles: return "idle";
+		case simak65_stop_break: return "break";
+		case simak65_stop_watch: return "watch";
+	}
+
+	return "?";
+}
+
+static int add(struct instance *inst, int count, const char *name)
+{
+	if (count == MAX_INSTANCES)
+		return count;
+
+	snprintf(inst[count].name, sizeof(inst[count].name), "%s", name);
+	inst[count].m = simak65_metrics_open(name);
+	inst[count].valid = 0;
+
+	return (inst[count].m != NULL) ? count + 1 : count;
+}
+
+static int scan(struct instance *inst)
+{
+	char name[258];
+	struct dirent *d;
+	DIR *dir;
+	int count = 0;
+
+	dir = opendir("/dev/shm");
+	if (dir == NULL)
+		return 0;
+
+	while ((d = readdir(dir)) != NULL) {
+		if (strncmp(d->d_name, "simak65", 7) == 0) {
+			snprintf(name, sizeof(name), "/%s", d->d_name);
+			count = add(inst, count, name);
+		}
+	}
+
+	closedir(dir);
+
+	return count;
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr, "Usage: %s [-i ms] [-n updates] [name...]\n", prog);
+	fprintf(stderr, "Without names all /dev/shm/simak65* blocks are shown.\n");
+}
+
+int main(int argc, char *argv[])
+{
+	static struct instance inst[MAX_INSTANCES];
+	struct simak65_metrics_sample s;
+	unsigned int interval = 1000;
+	int updates = -1, count = 0, i, opt;
+	double dt;
+
+	while ((opt = getopt(argc, argv, "i:n:h")) != -1) {
+		switch (opt) {
+			case 'i':
+				interval = strtoul(optarg, NULL, 0);
+				break;
+
+			case 'n':
+				updates = strtol(optarg, NULL, 0);
+				break;
+
+			default:
+				usage(argv[0]);
+				return (opt == 'h') ? 0 : 1;
+		}
+	}
+
+	for (i = optind; i < argc; ++i)
+		count = add(inst, count, argv[i]);
+
+	if (optind == argc)
+		count = scan(inst);
+
+	if (count == 0) {
+		fprintf(stderr, "No instances found\n");
+		return 1;
+	}
+
+	while (updates != 0) {
+		printf("%-24s %8s %8s %10s %10s %20s %6s\n", "name", "pid", "state", "MIPS", "MHz", "cycles", "pc");
+
+		for (i = 0; i < count; ++i) {
+			if (simak65_metrics_read(inst[i].m, &s) < 0) {
+				printf("%-24s busy\n", inst[i].name);
+				continue;
+			}
+
+			printf("%-24s %8u %8s ", inst[i].name, (unsigned int)s.pid, stop_name(s.stop));
+
+			/* Rates over the updates seen since the last refresh */
+			dt = inst[i].valid ? (double)(s.time - inst[i].last.time) : 0;
+			if (dt > 0) {
+				/* Instances built with SIMAK65_NO_PERF count no instructions */
+				if (s.instructions != 0)
+					printf("%10.3f ", (s.instructions - inst[i].last.instructions) * 1e3 / dt);
+				else
+					printf("%10s ", "-");
+				printf("%10.3f ", (s.cycles - inst[i].last.cycles) * 1e3 / dt);
+			}
+			else {
+				printf("%10s %10s ", "-", "-");
+			}
+
+			printf("%20llu  %04x\n", (unsigned long long)s.cycles, s.pc);
+
+			if (!inst[i].valid || s.time != inst[i].last.time) {
+				inst[i].last = s;
+				inst[i].valid = 1;
+			}
+		}
+
+		printf("\n");
+		fflush(stdout);
+
+		if (updates > 0)
+			--updates;
+
+		if (updates != 0)
+			usleep(interval * 1000);
+	}
+
+	for (i = 0; i < count; ++i)
+		simak65_metrics_destroy(inst[i].m);
+
+	return 0;
+}
@@ -0,0 +1,77 @@
+/* SimAK65 instruction trace
+ * Copyright A.K. 2026
+ *
+ * Single writer ring of binary records. The reader copies records without
+ * locking and drops the ones the writer could have overwritten meanwhile.
+ */
+
+#include <stdlib.h>
+#include "error.h"
+#include "trace.h"
+#include "hook.h"
+#include "simak65.h"
+
+struct simak65_trace *simak65_trace_create(unsigned int order)
+{
+	struct simak65_trace *trace;
+
+	if (order > 30)
+		return NULL;
+
+	trace = malloc(sizeof(*trace) + ((size_t)1 << order) * sizeof(trace->recs[0]));
+	if (trace == NULL)
+		return NULL;
+
+	trace->head = 0;
+	trace->mask = ((uint64_t)1 << order) - 1;
+
+	return trace;
+}
+
+void simak65_trace_destroy(struct simak65_trace *trace)
+{
+	free(trace);
+}
+
+void simak65_trace_attach(struct simak65_cpu *cpu, struct simak65_trace *trace)
+{
+	if (trace != NULL) {
+		__atomic_store_n(&cpu->trace, trace, __ATOMIC_RELEASE);
+		hook_set(cpu, HOOK_TRACE, 1);
+	}
+	else {
+		hook_set(cpu, HOOK_TRACE, 0);
+		__atomic_store_n(&cpu->trace, NULL, __ATOMIC_RELEASE);
+	}
+}
+
+unsigned int simak65_trace_read(struct simak65_trace *trace, struct simak65_trace_rec *recs, unsigned int count)
+{
+	uint64_t head, first, valid, i;
+	unsigned int skip;
+
+	head = __atomic_load_n(&trace->head, __ATOMIC_ACQUIRE);
+
+	if (count > trace->mask + 1)
+		count = trace->mask + 1;
+	if (count > head)
+		count = head;
+
+	first = head - count;
+	for (i = 0; i < count; ++i)
+		recs[i] = trace->recs[(first + i) & trace->mask];
+
+	/* Records the writer got to in the meantime are torn */
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	head = __atomic_load_n(&trace->head, __ATOMIC_RELAXED);
+	valid = head + 1 - (trace->mask + 1);
+
+	if (head + 1 > trace->mask + 1 && valid > first) {
+		skip = (valid - first < count) ? valid - first : count;
+		for (i = skip; i < count; ++i)
+			recs[i - skip] = recs[i];
+		count -= skip;
+	}
+
+	return count;
+}
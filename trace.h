@@ -0,0 +1,50 @@
+/* SimAK65 instruction trace
+ * Copyright A.K. 2026
+ */
+
+#ifndef SIMAK65_TRACE_H_
+#define SIMAK65_TRACE_H_
+
+#include "types.h"
+#include "addrmode.h"
+#include "bus.h"
+#include "simak65.h"
+
+struct simak65_trace {
+	/* Records written so far, published with release semantics */
+	uint64_t head;
+	uint64_t mask;
+	struct simak65_trace_rec recs[];
+};
+
+static inline void trace_fill(struct simak65_trace_rec *rec, struct simak65_cpu *cpu, u16 pc,
+		unsigned long cycles, u8 opcode, const u8 *operand, enum argtype argtype, const u8 *args)
+{
+	rec->cycles = cycles;
+	rec->pc = pc;
+	rec->ea = (argtype == arg_addr) ? (((u16)args[1] << 8) | args[0]) : 0;
+	rec->opcode = opcode;
+	rec->operand[0] = operand[0];
+	rec->operand[1] = operand[1];
+	rec->a = cpu->reg.a;
+	rec->x = cpu->reg.x;
+	rec->y = cpu->reg.y;
+	rec->sp = cpu->reg.sp;
+	rec->flags = cpu->reg.flags;
+}
+
+static inline void trace_record(struct simak65_trace *trace, struct simak65_cpu *cpu, u16 pc,
+		unsigned long cycles, u8 opcode, const u8 *operand, enum argtype argtype, const u8 *args)
+{
+	uint64_t head = trace->head;
+
+	trace_fill(&trace->recs[head & trace->mask], cpu, pc, cycles, opcode, operand, argtype, args);
+
+	__atomic_store_n(&trace->head, head + 1, __ATOMIC_RELEASE);
+
+	/* The next record must not be overwritten before head is visible,
+	 * a reader checks head again after copying */
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+#endif /* SIMAK65_TRACE_H_ */
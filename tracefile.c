@@ -0,0 +1,644 @@
+/* SimAK65 trace files
+ * Copyright A.K. 2026
+ *
+ * Records are delta encoded against the previous one and grouped in blocks.
+ * Full blocks are written by a background thread. Every block starts from
+ * a zeroed state, so it can be decoded on its own. The index at the end of
+ * the file holds the first cycle, first PC and a bitmap of executed code
+ * pages of every block.
+ *
+ * Record: mask, cycle delta (LEB128), opcode, operands, then fields
+ * selected by the mask: PC if not the one following the previous
+ * instruction, A, X, Y, SP, P if changed, effective address if not 0.
+ *
+ * All multibyte fields are little endian.
+ */
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "error.h"
+#include "decoder.h"
+#include "tracefile.h"
+#include "hook.h"
+#include "simak65.h"
+
+#define TF_MAGIC "SK65TRC1"
+#define TF_INDEX_MAGIC "SK65TIDX"
+#define TF_MAGIC_SIZE 8
+
+#define TF_BLOCK_SIZE (1 << 20)
+#define TF_BLOCK_HEADER 8
+#define TF_RECORD_MAX 32
+#define TF_BUFFERS 4
+
+#define TF_INDEX_SIZE 58
+#define TF_FOOTER_SIZE 24
+
+#define TF_PC    0x01
+#define TF_A     0x02
+#define TF_X     0x04
+#define TF_Y     0x08
+#define TF_SP    0x10
+#define TF_FLAGS 0x20
+#define TF_EA    0x40
+
+struct tf_block {
+	u8 *data;
+	unsigned int size;
+	unsigned int count;
+	uint64_t cycles;
+	u16 pc;
+	u32 pages[8];
+};
+
+struct tf_index {
+	uint64_t cycles;
+	uint64_t offset;
+	u32 count;
+	u32 size;
+	u16 pc;
+	u32 pages[8];
+};
+
+struct simak65_tracefile {
+	FILE *f;
+	int error;
+
+	/* Block being encoded and the delta base */
+	struct tf_block *cur;
+	struct simak65_trace_rec prev;
+
+	/* Blocks queued for the writer, and free ones */
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	pthread_t writer;
+	struct tf_block blocks[TF_BUFFERS];
+	struct tf_block *queue[TF_BUFFERS];
+	struct tf_block *free[TF_BUFFERS];
+	unsigned int nqueued;
+	unsigned int nfree;
+	int done;
+
+	/* Owned by the writer thread */
+	uint64_t offset;
+	struct tf_index *index;
+	unsigned int nindex;
+	unsigned int szindex;
+};
+
+struct tf_cursor {
+	unsigned int block;
+	const u8 *p;
+	const u8 *end;
+	unsigned int left;
+	struct simak65_trace_rec prev;
+};
+
+struct simak65_tracemap {
+	const u8 *base;
+	size_t size;
+	const u8 *index;
+	unsigned int nindex;
+	struct tf_cursor cur;
+};
+
+static u8 *tf_put(u8 *p, uint64_t v, unsigned int n)
+{
+	while (n--) {
+		*p++ = v & 0xff;
+		v >>= 8;
+	}
+
+	return p;
+}
+
+static uint64_t tf_get(const u8 *p, unsigned int n)
+{
+	uint64_t v = 0;
+
+	while (n--)
+		v = (v << 8) | p[n];
+
+	return v;
+}
+
+static u8 *tf_putv(u8 *p, uint64_t v)
+{
+	do {
+		*p++ = (v & 0x7f) | ((v > 0x7f) ? 0x80 : 0);
+		v >>= 7;
+	} while (v != 0);
+
+	return p;
+}
+
+static const u8 *tf_getv(const u8 *p, uint64_t *v)
+{
+	unsigned int shift = 0;
+
+	/* No more than the 10 bytes of a 64-bit value */
+	*v = 0;
+	do {
+		*v |= (uint64_t)(*p & 0x7f) << shift;
+		shift += 7;
+	} while ((*p++ & 0x80) && shift < 64);
+
+	return p;
+}
+
+static void tf_reset(struct simak65_trace_rec *rec)
+{
+	memset(rec, 0, sizeof(*rec));
+}
+
+static void *tf_writer(void *arg)
+{
+	struct simak65_tracefile *tf = arg;
+	struct tf_block *block;
+	struct tf_index *index;
+	u8 header[TF_BLOCK_HEADER];
+
+	pthread_mutex_lock(&tf->lock);
+	while (1) {
+		while (tf->nqueued == 0 && !tf->done)
+			pthread_cond_wait(&tf->cond, &tf->lock);
+
+		if (tf->nqueued == 0)
+			break;
+
+		block = tf->queue[0];
+		pthread_mutex_unlock(&tf->lock);
+
+		if (tf->nindex == tf->szindex) {
+			tf->szindex = tf->szindex ? tf->szindex * 2 : 256;
+			index = realloc(tf->index, tf->szindex * sizeof(*index));
+			if (index == NULL)
+				tf->error = 1;
+			else
+				tf->index = index;
+		}
+
+		if (!tf->error) {
+			index = &tf->index[tf->nindex++];
+			index->cycles = block->cycles;
+			index->offset = tf->offset + TF_BLOCK_HEADER;
+			index->count = block->count;
+			index->size = block->size;
+			index->pc = block->pc;
+			memcpy(index->pages, block->pages, sizeof(index->pages));
+
+			tf_put(tf_put(header, block->size, 4), block->count, 4);
+			if (fwrite(header, 1, sizeof(header), tf->f) != sizeof(header) ||
+					fwrite(block->data, 1, block->size, tf->f) != block->size)
+				tf->error = 1;
+
+			tf->offset += TF_BLOCK_HEADER + block->size;
+		}
+
+		pthread_mutex_lock(&tf->lock);
+		memmove(&tf->queue[0], &tf->queue[1], --tf->nqueued * sizeof(tf->queue[0]));
+		tf->free[tf->nfree++] = block;
+		pthread_cond_broadcast(&tf->cond);
+	}
+	pthread_mutex_unlock(&tf->lock);
+
+	return NULL;
+}
+
+static void tf_submit(struct simak65_tracefile *tf)
+{
+	struct tf_block *block = tf->cur;
+
+	pthread_mutex_lock(&tf->lock);
+	if (block->count != 0) {
+		tf->queue[tf->nqueued++] = block;
+		pthread_cond_broadcast(&tf->cond);
+
+		while (tf->nfree == 0)
+			pthread_cond_wait(&tf->cond, &tf->lock);
+
+		block = tf->free[--tf->nfree];
+	}
+	pthread_mutex_unlock(&tf->lock);
+
+	block->size = 0;
+	block->count = 0;
+	memset(block->pages, 0, sizeof(block->pages));
+	tf->cur = block;
+	tf_reset(&tf->prev);
+}
+
+void tracefile_record(struct simak65_tracefile *tf, const struct simak65_trace_rec *rec)
+{
+	struct tf_block *block = tf->cur;
+	const struct simak65_trace_rec *prev = &tf->prev;
+	u8 *p, *mask;
+	u8 len;
+
+	if (block->size > TF_BLOCK_SIZE - TF_RECORD_MAX) {
+		tf_submit(tf);
+		block = tf->cur;
+	}
+
+	if (block->count == 0) {
+		block->cycles = rec->cycles;
+		block->pc = rec->pc;
+	}
+
+	p = block->data + block->size;
+	mask = p++;
+	*mask = 0;
+
+	p = tf_putv(p, rec->cycles - prev->cycles);
+	*p++ = rec->opcode;
+
+	len = decode_length(rec->opcode);
+	if (len > 1)
+		*p++ = rec->operand[0];
+	if (len > 2)
+		*p++ = rec->operand[1];
+
+	if (rec->pc != (u16)(prev->pc + decode_length(prev->opcode))) {
+		*mask |= TF_PC;
+		p = tf_put(p, rec->pc, 2);
+	}
+
+	if (rec->a != prev->a) {
+		*mask |= TF_A;
+		*p++ = rec->a;
+	}
+
+	if (rec->x != prev->x) {
+		*mask |= TF_X;
+		*p++ = rec->x;
+	}
+
+	if (rec->y != prev->y) {
+		*mask |= TF_Y;
+		*p++ = rec->y;
+	}
+
+	if (rec->sp != prev->sp) {
+		*mask |= TF_SP;
+		*p++ = rec->sp;
+	}
+
+	if (rec->flags != prev->flags) {
+		*mask |= TF_FLAGS;
+		*p++ = rec->flags;
+	}
+
+	if (rec->ea != 0) {
+		*mask |= TF_EA;
+		p = tf_put(p, rec->ea, 2);
+	}
+
+	block->size = p - block->data;
+	++block->count;
+	block->pages[rec->pc >> 13] |= (u32)1 << ((rec->pc >> 8) & 0x1f);
+	tf->prev = *rec;
+}
+
+struct simak65_tracefile *simak65_tracefile_create(const char *path)
+{
+	struct simak65_tracefile *tf;
+	unsigned int i;
+
+	tf = calloc(1, sizeof(*tf));
+	if (tf == NULL)
+		return NULL;
+
+	tf->f = fopen(path, "wb");
+	if (tf->f == NULL) {
+		free(tf);
+		return NULL;
+	}
+
+	for (i = 0; i < TF_BUFFERS; ++i) {
+		tf->blocks[i].data = malloc(TF_BLOCK_SIZE);
+		if (tf->blocks[i].data == NULL)
+			tf->error = 1;
+		tf->free[tf->nfree++] = &tf->blocks[i];
+	}
+
+	if (fwrite(TF_MAGIC, 1, TF_MAGIC_SIZE, tf->f) != TF_MAGIC_SIZE)
+		tf->error = 1;
+	tf->offset = TF_MAGIC_SIZE;
+
+	pthread_mutex_init(&tf->lock, NULL);
+	pthread_cond_init(&tf->cond, NULL);
+
+	if (tf->error || pthread_create(&tf->writer, NULL, tf_writer, tf) != 0) {
+		for (i = 0; i < TF_BUFFERS; ++i)
+			free(tf->blocks[i].data);
+		pthread_mutex_destroy(&tf->lock);
+		pthread_cond_destroy(&tf->cond);
+		fclose(tf->f);
+		free(tf);
+		return NULL;
+	}
+
+	tf->cur = tf->free[--tf->nfree];
+	tf_submit(tf);
+
+	return tf;
+}
+
+int simak65_tracefile_close(struct simak65_tracefile *tf)
+{
+	u8 buf[TF_INDEX_SIZE], *p;
+	unsigned int i, j;
+	uint64_t offset;
+	int err;
+
+	tf_submit(tf);
+
+	pthread_mutex_lock(&tf->lock);
+	tf->done = 1;
+	pthread_cond_broadcast(&tf->cond);
+	pthread_mutex_unlock(&tf->lock);
+	pthread_join(tf->writer, NULL);
+
+	offset = tf->offset;
+	for (i = 0; i < tf->nindex && !tf->error; ++i) {
+		p = tf_put(buf, tf->index[i].cycles, 8);
+		p = tf_put(p, tf->index[i].offset, 8);
+		p = tf_put(p, tf->index[i].count, 4);
+		p = tf_put(p, tf->index[i].size, 4);
+		p = tf_put(p, tf->index[i].pc, 2);
+		for (j = 0; j < 8; ++j)
+			p = tf_put(p, tf->index[i].pages[j], 4);
+
+		if (fwrite(buf, 1, sizeof(buf), tf->f) != sizeof(buf))
+			tf->error = 1;
+	}
+
+	p = tf_put(buf, offset, 8);
+	p = tf_put(p, tf->nindex, 8);
+	memcpy(p, TF_INDEX_MAGIC, TF_MAGIC_SIZE);
+	if (fwrite(buf, 1, TF_FOOTER_SIZE, tf->f) != TF_FOOTER_SIZE)
+		tf->error = 1;
+
+	if (fclose(tf->f) != 0)
+		tf->error = 1;
+
+	err = tf->error ? -1 : 0;
+
+	for (i = 0; i < TF_BUFFERS; ++i)
+		free(tf->blocks[i].data);
+	pthread_mutex_destroy(&tf->lock);
+	pthread_cond_destroy(&tf->cond);
+	free(tf->index);
+	free(tf);
+
+	return err;
+}
+
+void simak65_tracefile_attach(struct simak65_cpu *cpu, struct simak65_tracefile *tf)
+{
+	cpu->tracefile = tf;
+	hook_set(cpu, HOOK_TRACEFILE, tf != NULL);
+}
+
+static const u8 *tm_index(const struct simak65_tracemap *tm, unsigned int block)
+{
+	return tm->index + (size_t)block * TF_INDEX_SIZE;
+}
+
+static int tm_block(struct simak65_tracemap *tm, unsigned int block)
+{
+	const u8 *index;
+
+	if (block >= tm->nindex)
+		return -1;
+
+	index = tm_index(tm, block);
+	tm->cur.block = block;
+	tm->cur.p = tm->base + tf_get(index + 8, 8);
+	tm->cur.end = tm->cur.p + tf_get(index + 20, 4);
+	tm->cur.left = tf_get(index + 16, 4);
+	tf_reset(&tm->cur.prev);
+
+	return 0;
+}
+
+static int tm_decode(struct simak65_tracemap *tm, struct simak65_trace_rec *rec)
+{
+	struct tf_cursor *cur = &tm->cur;
+	u8 tail[TF_RECORD_MAX];
+	uint64_t delta;
+	const u8 *p, *start;
+	size_t avail;
+	u8 mask, len;
+
+	while (cur->left == 0) {
+		if (tm_block(tm, cur->block + 1) < 0)
+			return -1;
+	}
+
+	/* Near the block end the record is decoded from a padded copy, a
+	 * corrupt one must not be read past the end */
+	avail = cur->end - cur->p;
+	if (avail < TF_RECORD_MAX) {
+		memset(tail, 0, sizeof(tail));
+		memcpy(tail, cur->p, avail);
+		p = tail;
+	}
+	else {
+		p = cur->p;
+	}
+
+	start = p;
+	*rec = cur->prev;
+
+	mask = *p++;
+	p = tf_getv(p, &delta);
+	rec->cycles += delta;
+	rec->pc += decode_length(rec->opcode);
+	rec->opcode = *p++;
+
+	len = decode_length(rec->opcode);
+	rec->operand[0] = (len > 1) ? *p++ : 0;
+	rec->operand[1] = (len > 2) ? *p++ : 0;
+
+	if (mask & TF_PC) {
+		rec->pc = tf_get(p, 2);
+		p += 2;
+	}
+
+	if (mask & TF_A)
+		rec->a = *p++;
+	if (mask & TF_X)
+		rec->x = *p++;
+	if (mask & TF_Y)
+		rec->y = *p++;
+	if (mask & TF_SP)
+		rec->sp = *p++;
+	if (mask & TF_FLAGS)
+		rec->flags = *p++;
+
+	rec->ea = 0;
+	if (mask & TF_EA) {
+		rec->ea = tf_get(p, 2);
+		p += 2;
+	}
+
+	if ((size_t)(p - start) > avail) {
+		WARN("Corrupted trace block %u", cur->block);
+		cur->left = 0;
+		cur->block = tm->nindex;
+		return -1;
+	}
+
+	cur->p += p - start;
+	--cur->left;
+	cur->prev = *rec;
+
+	return 0;
+}
+
+struct simak65_tracemap *simak65_tracemap_open(const char *path)
+{
+	struct simak65_tracemap *tm;
+	struct stat st;
+	const u8 *footer, *index;
+	uint64_t offset, count, start, i;
+	void *base;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+
+	if (fstat(fd, &st) < 0 || st.st_size < TF_MAGIC_SIZE + TF_FOOTER_SIZE) {
+		close(fd);
+		return NULL;
+	}
+
+	base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED)
+		return NULL;
+
+	footer = (const u8 *)base + st.st_size - TF_FOOTER_SIZE;
+	offset = tf_get(footer, 8);
+	count = tf_get(footer + 8, 8);
+
+	if (memcmp(base, TF_MAGIC, TF_MAGIC_SIZE) != 0 || memcmp(footer + 16, TF_INDEX_MAGIC, TF_MAGIC_SIZE) != 0 ||
+			offset > (uint64_t)st.st_size || count > (uint64_t)st.st_size / TF_INDEX_SIZE ||
+			offset + count * TF_INDEX_SIZE + TF_FOOTER_SIZE != (uint64_t)st.st_size) {
+		WARN("Invalid trace file %s", path);
+		munmap(base, st.st_size);
+		return NULL;
+	}
+
+	/* Blocks lie between the magic and the index */
+	for (i = 0; i < count; ++i) {
+		index = (const u8 *)base + offset + i * TF_INDEX_SIZE;
+		start = tf_get(index + 8, 8);
+		if (start < TF_MAGIC_SIZE || start > offset || tf_get(index + 20, 4) > offset - start) {
+			WARN("Invalid trace file %s: block %lu out of bounds", path, (unsigned long)i);
+			munmap(base, st.st_size);
+			return NULL;
+		}
+	}
+
+	tm = malloc(sizeof(*tm));
+	if (tm == NULL) {
+		munmap(base, st.st_size);
+		return NULL;
+	}
+
+	tm->base = base;
+	tm->size = st.st_size;
+	tm->index = tm->base + offset;
+	tm->nindex = count;
+	tm->cur.block = 0;
+	tm->cur.left = 0;
+	tm_block(tm, 0);
+
+	return tm;
+}
+
+void simak65_tracemap_close(struct simak65_tracemap *tm)
+{
+	munmap((void *)tm->base, tm->size);
+	free(tm);
+}
+
+int simak65_tracemap_next(struct simak65_tracemap *tm, struct simak65_trace_rec *rec)
+{
+	return tm_decode(tm, rec);
+}
+
+int simak65_tracemap_seek(struct simak65_tracemap *tm, uint64_t cycles)
+{
+	struct simak65_trace_rec rec;
+	struct tf_cursor last;
+	unsigned int lo = 0, hi = tm->nindex, mid;
+
+	if (tm->nindex == 0 || tf_get(tm_index(tm, 0), 8) > cycles) {
+		tm_block(tm, 0);
+		return -1;
+	}
+
+	/* Last block starting at or before the cycle */
+	while (hi - lo > 1) {
+		mid = (lo + hi) / 2;
+		if (tf_get(tm_index(tm, mid), 8) <= cycles)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	tm_block(tm, lo);
+	last = tm->cur;
+
+	while (1) {
+		struct tf_cursor at = tm->cur;
+
+		if (tm_decode(tm, &rec) < 0 || rec.cycles > cycles)
+			break;
+
+		last = at;
+	}
+
+	tm->cur = last;
+
+	return 0;
+}
+
+int simak65_tracemap_find_pc(struct simak65_tracemap *tm, uint16_t pc)
+{
+	struct simak65_trace_rec rec;
+	struct tf_cursor at;
+	const u8 *index;
+	u32 pages;
+
+	while (1) {
+		if (tm->cur.left == 0 && tm_block(tm, tm->cur.block + 1) < 0)
+			return -1;
+
+		/* Skip whole blocks which never executed the page */
+		index = tm_index(tm, tm->cur.block);
+		pages = tf_get(index + 26 + (pc >> 13) * 4, 4);
+		if (!(pages & ((u32)1 << ((pc >> 8) & 0x1f)))) {
+			tm->cur.left = 0;
+			continue;
+		}
+
+		at = tm->cur;
+		if (tm_decode(tm, &rec) < 0)
+			return -1;
+
+		if (rec.pc == pc) {
+			tm->cur = at;
+			return 0;
+		}
+	}
+}
@@ -0,0 +1,14 @@
+/* SimAK65 trace files
+ * Copyright A.K. 2026
+ */
+
+#ifndef SIMAK65_TRACEFILE_H_
+#define SIMAK65_TRACEFILE_H_
+
+#include "types.h"
+#include "simak65.h"
+
+/* Encode the record into the current block, hands full blocks to the writer */
+void tracefile_record(struct simak65_tracefile *tf, const struct simak65_trace_rec *rec);
+
+#endif /* SIMAK65_TRACEFILE_H_ */
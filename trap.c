@@ -0,0 +1,126 @@
+/* SimAK65 native routine traps
+ * Copyright A.K. 2026
+ *
+ * A trap replaces the guest routine at an address with a host callback.
+ * The callback runs when the routine is entered, chooses the cycles it
+ * takes and the routine returns as with RTS.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "error.h"
+#include "trap.h"
+#include "exec.h"
+#include "bus.h"
+#include "memo.h"
+#include "simak65.h"
+
+static struct trap_entry *trap_find(struct simak65_traps *traps, u16 addr)
+{
+	unsigned int i;
+
+	for (i = 0; i < traps->count; ++i) {
+		if (traps->entries[i].addr == addr)
+			return &traps->entries[i];
+	}
+
+	return NULL;
+}
+
+int simak65_trap_set(struct simak65_cpu *cpu, uint16_t addr, simak65_trap_fn fn, void *arg)
+{
+	struct simak65_traps *traps = cpu->traps;
+	struct trap_entry *entry, *entries;
+
+	if (traps == NULL) {
+		traps = calloc(1, sizeof(*traps));
+		if (traps == NULL)
+			return -1;
+
+		cpu->traps = traps;
+	}
+
+	entry = trap_find(traps, addr);
+	if (entry == NULL) {
+		if (traps->count == traps->size) {
+			entries = realloc(traps->entries, (traps->size ? 2 * traps->size : 16) * sizeof(*entries));
+			if (entries == NULL) {
+				if (traps->count == 0)
+					simak65_trap_clear_all(cpu);
+				return -1;
+			}
+
+			traps->entries = entries;
+			traps->size = traps->size ? 2 * traps->size : 16;
+		}
+
+		entry = &traps->entries[traps->count++];
+		entry->addr = addr;
+		traps->bitmap[addr >> 3] |= 1 << (addr & 7);
+	}
+
+	entry->fn = fn;
+	entry->arg = arg;
+
+	DEBUG("Trap set at 0x%04x", addr);
+
+	return 0;
+}
+
+void simak65_trap_clear(struct simak65_cpu *cpu, uint16_t addr)
+{
+	struct simak65_traps *traps = cpu->traps;
+	struct trap_entry *entry;
+
+	if (traps == NULL || (entry = trap_find(traps, addr)) == NULL)
+		return;
+
+	*entry = traps->entries[--traps->count];
+	traps->bitmap[addr >> 3] &= ~(1 << (addr & 7));
+
+	if (traps->count == 0)
+		simak65_trap_clear_all(cpu);
+}
+
+void simak65_trap_clear_all(struct simak65_cpu *cpu)
+{
+	if (cpu->traps == NULL)
+		return;
+
+	free(cpu->traps->entries);
+	free(cpu->traps);
+	cpu->traps = NULL;
+}
+
+int trap_run(struct simak65_cpu *cpu)
+{
+	struct trap_entry *entry;
+	int cycles;
+
+	if (!trap_test(cpu->traps, cpu->reg.pc))
+		return -1;
+
+	/* Registers and memory used by the callback are unknown */
+	if (cpu->memo_rec != NULL)
+		memo_fail(cpu, "trapped");
+
+	entry = trap_find(cpu->traps, cpu->reg.pc);
+	cycles = entry->fn(cpu, entry->arg);
+	if (cycles < 0)
+		return -1;
+
+	cpu->cycles += cycles;
+	exec_return(cpu);
+
+	return 0;
+}
+
+uint8_t simak65_mem_read(struct simak65_cpu *cpu, uint16_t addr)
+{
+	return bus_read(cpu, addr);
+}
+
+void simak65_mem_write(struct simak65_cpu *cpu, uint16_t addr, uint8_t data)
+{
+	bus_write(cpu, addr, data);
+}
@@ -0,0 +1,33 @@
+/* SimAK65 native routine traps
+ * Copyright A.K. 2026
+ */
+
+#ifndef SIMAK65_TRAP_H_
+#define SIMAK65_TRAP_H_
+
+#include "types.h"
+#include "simak65.h"
+
+struct trap_entry {
+	u16 addr;
+	simak65_trap_fn fn;
+	void *arg;
+};
+
+struct simak65_traps {
+	u8 bitmap[0x10000 / 8];
+	struct trap_entry *entries;
+	unsigned int count;
+	unsigned int size;
+};
+
+/* Run the routine at pc natively if it is trapped, returns -1 if the
+ * instruction there has to be executed */
+int trap_run(struct simak65_cpu *cpu);
+
+static inline int trap_test(const struct simak65_traps *traps, u16 addr)
+{
+	return traps->bitmap[addr >> 3] & (1 << (addr & 7));
+}
+
+#endif /* SIMAK65_TRAP_H_ */
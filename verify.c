@@ -0,0 +1,188 @@
+/* SimAK65 parallel replay verification
+ * Copyright A.K. 2026
+ *
+ * Every segment between two consecutive checkpoints is replayed on its own
+ * CPU instance against private memory, with I/O input fed from the log.
+ * A segment passes if it ends in the state saved in the next checkpoint.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "error.h"
+#include "snapshot.h"
+#include "log.h"
+#include "simak65.h"
+
+struct verify {
+	const char *path;
+	struct simak65_snapshot **cps;
+	unsigned int count;
+	unsigned int next;
+	int *result;
+};
+
+static __thread u8 *verify_mem;
+
+static u8 verify_read(u16 addr)
+{
+	return verify_mem[addr];
+}
+
+static void verify_write(u16 addr, u8 data)
+{
+	verify_mem[addr] = data;
+}
+
+static void verify_load(const struct simak65_snapshot *snap)
+{
+	unsigned int page;
+	const u8 *data;
+
+	for (page = 0; page < SNAPSHOT_PAGES; ++page) {
+		data = snapshot_page(snap, page);
+		if (data != NULL)
+			memcpy(verify_mem + page * SNAPSHOT_PAGE_SIZE, data, SNAPSHOT_PAGE_SIZE);
+		else
+			memset(verify_mem + page * SNAPSHOT_PAGE_SIZE, 0, SNAPSHOT_PAGE_SIZE);
+	}
+}
+
+static int verify_compare(const struct simak65_cpu *cpu, const struct simak65_snapshot *snap)
+{
+	unsigned int page;
+	const u8 *data;
+
+	if (cpu->reg.pc != snap->pc || cpu->reg.a != snap->a || cpu->reg.x != snap->x ||
+			cpu->reg.y != snap->y || cpu->reg.sp != snap->sp || cpu->reg.flags != snap->flags ||
+			cpu->cycles != snap->cycles)
+		return -1;
+
+	for (page = 0; page < SNAPSHOT_PAGES; ++page) {
+		data = snapshot_page(snap, page);
+		if (data != NULL && memcmp(verify_mem + page * SNAPSHOT_PAGE_SIZE, data, SNAPSHOT_PAGE_SIZE) != 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+/* Returns 0 if the segment matches, 1 if it diverged, -1 on error */
+static int verify_segment(struct simak65_cpu *cpu, const struct simak65_snapshot *start, const struct simak65_snapshot *end)
+{
+	if (log_segment(cpu->log, start->logpos, end->logpos) < 0)
+		return -1;
+
+	verify_load(start);
+	cpu->reg.pc = start->pc;
+	cpu->reg.a = start->a;
+	cpu->reg.x = start->x;
+	cpu->reg.y = start->y;
+	cpu->reg.sp = start->sp;
+	cpu->reg.flags = start->flags;
+	cpu->cycles = start->cycles;
+
+	log_step(cpu);
+	while (cpu->cycles < end->cycles)
+		simak65_step(cpu);
+
+	if (cpu->log->error || cpu->log->pos != end->logpos)
+		return 1;
+
+	return (verify_compare(cpu, end) < 0) ? 1 : 0;
+}
+
+static void *verify_thread(void *arg)
+{
+	struct verify *v = arg;
+	struct simak65_cpu cpu;
+	unsigned int i;
+	int ok;
+	FILE *f;
+
+	verify_mem = calloc(SNAPSHOT_PAGES, SNAPSHOT_PAGE_SIZE);
+	f = fopen(v->path, "rb");
+
+	simak65_init(&cpu);
+	cpu.bus.read = verify_read;
+	cpu.bus.write = verify_write;
+	memcpy(cpu.io, v->cps[0]->io, sizeof(cpu.io));
+
+	/* The log is opened once, each segment only seeks in it */
+	ok = (verify_mem != NULL && f != NULL && log_open(&cpu, f) == 0);
+
+	while ((i = __atomic_fetch_add(&v->next, 1, __ATOMIC_RELAXED)) < v->count - 1) {
+		if (!ok)
+			v->result[i] = -1;
+		else
+			v->result[i] = verify_segment(&cpu, v->cps[i], v->cps[i + 1]);
+
+		DEBUG("Segment %u %s", i, v->result[i] ? "diverged" : "matches");
+	}
+
+	simak65_log_stop(&cpu);
+	if (f != NULL)
+		fclose(f);
+	free(verify_mem);
+
+	return NULL;
+}
+
+int simak65_verify(const char *path, struct simak65_snapshot **cps, unsigned int count, unsigned int threads, unsigned int *segment)
+{
+	struct verify v;
+	pthread_t *tids;
+	unsigned int i, started;
+	int err = 0;
+
+	if (count < 2)
+		return 0;
+
+	if (threads == 0)
+		threads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (threads > count - 1)
+		threads = count - 1;
+
+	v.path = path;
+	v.cps = cps;
+	v.count = count;
+	v.next = 0;
+	v.result = calloc(count - 1, sizeof(*v.result));
+	tids = malloc(threads * sizeof(*tids));
+
+	if (v.result == NULL || tids == NULL) {
+		free(v.result);
+		free(tids);
+		return -1;
+	}
+
+	for (started = 0; started < threads; ++started) {
+		if (pthread_create(&tids[started], NULL, verify_thread, &v) != 0)
+			break;
+	}
+
+	/* Fall back to this thread if none could be started */
+	if (started == 0)
+		verify_thread(&v);
+
+	for (i = 0; i < started; ++i)
+		pthread_join(tids[i], NULL);
+
+	for (i = 0; i < count - 1; ++i) {
+		if (v.result[i] < 0) {
+			err = -1;
+			break;
+		}
+
+		if (v.result[i] > 0 && err == 0) {
+			*segment = i;
+			err = 1;
+		}
+	}
+
+	free(v.result);
+	free(tids);
+
+	return err;
+}
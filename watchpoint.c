@@ -0,0 +1,73 @@
+/* SimAK65 watchpoints
+ * Copyright A.K. 2026
+ *
+ * Read and write watchpoints are kept in separate bitmaps over the address
+ * space, each allocated only while it has a watched address. A hit lets
+ * the instruction finish and stops simak65_run() after it.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "error.h"
+#include "watchpoint.h"
+#include "simak65.h"
+
+#define WATCHPOINT_BITMAP_SIZE (0x10000 / 8)
+
+void watchpoint_hit(struct simak65_cpu *cpu, u16 addr, int write)
+{
+	DEBUG("Watchpoint %s at 0x%04x", write ? "write" : "read", addr);
+
+	cpu->stop = simak65_stop_watch;
+	cpu->watch.addr = addr;
+	cpu->watch.write = write;
+}
+
+static int watchpoint_update(u8 **bitmap, uint16_t start, uint16_t end, int set)
+{
+	static const u8 zero[WATCHPOINT_BITMAP_SIZE];
+	unsigned int addr;
+
+	if (*bitmap == NULL) {
+		if (!set)
+			return 0;
+
+		*bitmap = calloc(1, WATCHPOINT_BITMAP_SIZE);
+		if (*bitmap == NULL)
+			return -1;
+	}
+
+	for (addr = start; addr <= end; ++addr) {
+		if (set)
+			(*bitmap)[addr >> 3] |= 1 << (addr & 7);
+		else
+			(*bitmap)[addr >> 3] &= ~(1 << (addr & 7));
+	}
+
+	if (!set && memcmp(*bitmap, zero, WATCHPOINT_BITMAP_SIZE) == 0) {
+		free(*bitmap);
+		*bitmap = NULL;
+	}
+
+	return 0;
+}
+
+int simak65_watch_set(struct simak65_cpu *cpu, uint16_t start, uint16_t end, int type)
+{
+	if ((type & SIMAK65_WATCH_READ) && watchpoint_update(&cpu->watch_read, start, end, 1) < 0)
+		return -1;
+
+	if ((type & SIMAK65_WATCH_WRITE) && watchpoint_update(&cpu->watch_write, start, end, 1) < 0)
+		return -1;
+
+	return 0;
+}
+
+void simak65_watch_clear(struct simak65_cpu *cpu, uint16_t start, uint16_t end, int type)
+{
+	if (type & SIMAK65_WATCH_READ)
+		watchpoint_update(&cpu->watch_read, start, end, 0);
+
+	if (type & SIMAK65_WATCH_WRITE)
+		watchpoint_update(&cpu->watch_write, start, end, 0);
+}
@@ -0,0 +1,19 @@
+/* SimAK65 watchpoints
+ * Copyright A.K. 2026
+ */
+
+#ifndef SIMAK65_WATCHPOINT_H_
+#define SIMAK65_WATCHPOINT_H_
+
+#include "types.h"
+#include "simak65.h"
+
+void watchpoint_hit(struct simak65_cpu *cpu, u16 addr, int write);
+
+static inline void watchpoint_check(struct simak65_cpu *cpu, const u8 *bitmap, u16 addr, int write)
+{
+	if (bitmap[addr >> 3] & (1 << (addr & 7)))
+		watchpoint_hit(cpu, addr, write);
+}
+
+#endif /* SIMAK65_WATCHPOINT_H_ */